@@ -25,13 +25,16 @@
 #endif
 
 #include "Typelist.h"
-#include "Factory.h"
 
-#include "finit.h"
 #include "gfftomp.h"
 #include "gfftpolicy.h"
 #include "gfftcaller.h"
 #include "gfftgen.h"
+#include "gffttranspose.h"
+#include "gfftr2r.h"
+#include "gfftconv.h"
+#include "gfftstft.h"
+#include "gfftisa.h"
 
 #if FULLOUTPUT == 1 
 #define FOUT
@@ -23,10 +23,15 @@
 #include "gfftspec_inp.h"
 #include "gfftfactor.h"
 #include "gfftswap.h"
+#include "gfftcache.h"
+#include "gfftsimd.h"
 
 #include "metacomplex.h"
 #include "metaroot.h"
 
+#include <vector>
+#include <cmath>
+
 namespace GFFT {
 
 using namespace MF;
@@ -34,6 +39,34 @@ using namespace MF;
 static const int_t StaticLoopLimit = (1<<10);
 static const int_t PrecomputeRoots = StaticLoopLimit;
 
+/** \var static const int_t BluesteinThreshold
+Prime lengths above this value are transformed by the Bluestein's algorithm
+instead of the direct O(N^2) DFT, which also requires the compile-time 
+twiddle factors for N
+*/
+static const int_t BluesteinThreshold = 41;
+
+template<int_t N, int_t SI, int_t DI, typename VType, int S>
+class Bluestein;
+
+/** \var static const int_t RaderThreshold
+Prime radices above this value are computed by the Rader's algorithm
+in the scaled DFT stages (DFTk_x_Im_T) instead of the direct O(K^2) DFT
+*/
+static const int_t RaderThreshold = 13;
+
+/// Radix K is computed by Rader's algorithm: a prime above RaderThreshold
+/** The radices 2^r of GroupPowersOf2 have their own kernels.
+*/
+template<int_t K>
+struct RaderRadix {
+   static const bool value = (K > RaderThreshold) && (K % 2 != 0);
+};
+
+template<int_t N, int_t M, typename VType, int S,
+bool isStd = Loki::TypeTraits<typename VType::ValueType>::isStdFundamental>
+class DFTk_inp_rader;
+
 
 ///////////////////////////////////////////////////
 // This class works, but takes too much compile-time
@@ -173,13 +206,35 @@ class DFTk_x_Im_T<K,LastK,M,Step,VType,S,W1,SimpleSpec,true>
    static const int_t N = K*M;
    static const int_t M2 = M*2;
    static const int_t S2 = 2*Step;
-   DFTk_inp<K,M2,VType,S> spec_inp;
+   typedef typename Loki::Select<RaderRadix<K>::value, 
+     DFTk_inp_rader<K,M2,VType,S>, DFTk_inp<K,M2,VType,S> >::Result Spec;
+   Spec spec_inp;
+   typedef DFTk_x_Im_T_simd<K,M,VType,S,W1,(!RaderRadix<K>::value && Step == 1)> SpecSIMD;
+   SpecSIMD spec_simd;
+   // the vectorized stage has its own table
+   TwiddleTable<K,SimpleSpec,T,S,(TwiddleTables && !SpecSIMD::Enabled)> m_tab;
    
 public:
    void apply(T* data) 
    {
+      if (spec_simd.Enabled) {
+	spec_simd.apply(data);
+	return;
+      }
       spec_inp.apply(data);
 
+      if (TwiddleTables) {
+	T wr[K-1], wi[K-1];
+	for (int_t j=1; j<SimpleSpec; ++j) {
+	  for (int_t k=0; k<K-1; ++k) {
+	    wr[k] = m_tab.get(k+1)[2*j];
+	    wi[k] = m_tab.get(k+1)[2*j+1];
+	  }
+	  spec_inp.apply(data + j*S2, wr, wi);
+	}
+	return;
+      }
+
       ComputeRoots<K,VType,W1> roots;
 
       spec_inp.apply(data+S2, roots.get_real(), roots.get_imag());
@@ -239,10 +294,25 @@ class DFTk_x_Im_T<2,LastK,M,Step,VType,S,W1,SimpleSpec,true>
    typedef Compute<typename W1::Re,VType::Accuracy> WR;
    typedef Compute<typename W1::Im,VType::Accuracy> WI;
    DFTk_inp<2,N,VType,S> spec_inp;
+   typedef DFTk_x_Im_T_simd<2,M,VType,S,W1,(Step == 1)> SpecSIMD;
+   SpecSIMD spec_simd;
+   TwiddleTable<2,SimpleSpec,T,S,(TwiddleTables && !SpecSIMD::Enabled)> m_tab;
 public:
    void apply(T* data) 
    {
+      if (spec_simd.Enabled) {
+	spec_simd.apply(data);
+	return;
+      }
       spec_inp.apply(data);
+
+      if (TwiddleTables) {
+	const T* w = m_tab.get(1);
+	for (int_t j=1; j<SimpleSpec; ++j)
+	  spec_inp.apply(data + j*S2, w + 2*j, w + 2*j + 1);
+	return;
+      }
+
       if (M%2 == 0) 
 	spec_inp.apply_1(data+M);
       
@@ -383,19 +453,21 @@ The scaled DFT is performed afterwards.
 template<int_t N, typename NFact, typename VType, int S, class W1, int_t LastK = 1>
 class InTime;
 
-template<int_t N, typename Head, typename Tail, typename VType, int S, class W1, int_t LastK>
-class InTime<N, Loki::Typelist<Head,Tail>, VType, S, W1, LastK>
+/// Stands for the in-place transform of a length, which is not a power of a prime
+/** IN_PLACE::List selects it, so that such a transform does not compile.
+*/
+template<typename T>
+class InPlaceNotAllowed
 {
-   typedef typename VType::ValueType T;
-//   // Not implemented, because not allowed
-   void apply(T* data) 
-   {
-//#error Transforms in-place are allowed for powers of primes only!!!
-   }
+   // Not implemented, because not allowed:
+   // transforms in-place are allowed for powers of primes only
+   void apply(T* data) { }
 };
 
-template<int_t N, typename Head, typename VType, int S, class W1, int_t LastK>
-class InTime<N, Loki::Typelist<Head,Loki::NullType>, VType, S, W1, LastK>
+// Transforms in-place are allowed for powers of primes only (see InPlaceNotAllowed),
+// several factors are the radices of the grouped powers of two (GroupPowersOf2)
+template<int_t N, typename Head, typename Tail, typename VType, int S, class W1, int_t LastK>
+class InTime<N, Loki::Typelist<Head,Tail>, VType, S, W1, LastK>
 {
    typedef typename VType::ValueType T;
    typedef typename VType::TempType LocalVType;
@@ -407,7 +479,7 @@ class InTime<N, Loki::Typelist<Head,Loki::NullType>, VType, S, W1, LastK>
    static const int_t N2 = N*C;
    
    typedef typename IPowBig<W1,K>::Result WK;
-   typedef Loki::Typelist<Pair<typename Head::first, SInt<Head::second::value-1> >, Loki::NullType> NFactNext;
+   typedef Loki::Typelist<Pair<typename Head::first, SInt<Head::second::value-1> >, Tail> NFactNext;
    InTime<M,NFactNext,VType,S,WK,K*LastK> dft_str;
    DFTk_x_Im_T<K,K*LastK,M,1,VType,S,W1> dft_scaled;
 public:
@@ -427,13 +499,15 @@ class InTime<N, Loki::Typelist<Pair<SInt<K>, SInt<0> >,Tail>, VType, S, W1, Last
 : public InTime<N, Tail, VType, S, W1, LastK> {};
 
 
-// Specialization for a prime N
+// Specialization for a prime N or the last radix of the grouped powers of two
 template<int_t N, typename VType, int S, class W1, int_t LastK>
 class InTime<N,Loki::Typelist<Pair<SInt<N>, SInt<1> >, Loki::NullType>,VType,S,W1,LastK> 
 {
   typedef typename VType::ValueType T;
   static const int C = Loki::TypeTraits<T>::isStdFundamental ? 2 : 1;
-  DFTk_inp<N, C, VType, S> spec_inp;
+  typedef typename Loki::Select<(N > BluesteinThreshold), 
+    Bluestein<N, C, C, VType, S>, DFTk_inp<N, C, VType, S> >::Result Spec;
+  Spec spec_inp;
 public:
   void apply(T* data) 
   { 
@@ -476,14 +550,15 @@ class InTimeOOP<N, Loki::Typelist<Head,Tail>, VType, S, W1, LastK>
    typedef Loki::Typelist<Pair<typename Head::first, SInt<Head::second::value-1> >, Tail> NFactNext;
    InTimeOOP<M,NFactNext,VType,S,WK,K*LastK> dft_str;
    DFTk_x_Im_T<K,K*LastK,M,1,VType,S,W1> dft_scaled;
+   // the blocks in the order of the input of DFTk_inp
+   typedef KernelInputOrder<K> Order;
 public:
 
    void apply(const T* src, T* dst) 
    {
      // run strided DFT recursively K times
-      int_t lk = 0;
-      for (int_t m = 0; m < N2; m+=M2, lk+=LastK2)
-        dft_str.apply(src + lk, dst + m);
+      for (int_t i = 0; i < K; ++i)
+        dft_str.apply(src + Order::value(i)*LastK2, dst + i*M2);
 
       dft_scaled.apply(dst);
    }
@@ -495,18 +570,330 @@ class InTimeOOP<N, Loki::Typelist<Pair<SInt<K>, SInt<0> >,Tail>, VType, S, W1, L
 : public InTimeOOP<N, Tail, VType, S, W1, LastK> {};
 
 
-// Specialization for prime N
+// Specialization for a prime N or the last radix of the grouped powers of two
 template<int_t N, typename VType, int S, class W1, int_t LastK>
 class InTimeOOP<N,Loki::Typelist<Pair<SInt<N>, SInt<1> >, Loki::NullType>,VType,S,W1,LastK> 
 {
    typedef typename VType::ValueType T;
    static const int C = Loki::TypeTraits<T>::isStdFundamental ? 2 : 1;
-   DFTk<N, LastK*C, C, VType, S> spec;
+   typedef typename Loki::Select<(N > BluesteinThreshold), 
+     Bluestein<N, LastK*C, C, VType, S>, DFTk<N, LastK*C, C, VType, S> >::Result Spec;
+   Spec spec;
 public:
    void apply(const T* src, T* dst) { spec.apply(src, dst); }
 };
 
 
+/// Value type with interleaved (real,imag) storage and the same precision as VType
+/** std::complex is layout compatible with an array of two base_type values,
+    so the data of complex value types can be processed as interleaved.
+*/
+template<class VType,
+bool isStd = Loki::TypeTraits<typename VType::ValueType>::isStdFundamental>
+struct InterleavedType {
+   typedef VType Result;
+};
+
+template<class VType>
+struct InterleavedType<VType,false> {
+   struct Result {
+      typedef typename VType::base_type base_type;
+      typedef base_type ValueType;
+      typedef typename VType::TempType::value_type TempType;
+      static const int Accuracy = VType::Accuracy;
+   };
+};
+
+
+/// Bluestein's (chirp-z) algorithm for a prime length
+/*!
+\tparam N length of the data
+\tparam SI step in the source data
+\tparam DI step in the result data
+\tparam VType value type
+\tparam S sign of the transform: 1 - forward, -1 - backward
+
+Using nk = (n^2 + k^2 - (k-n)^2)/2, DFT of the length N is computed as 
+a cyclic convolution of the length M >= 2N-1 with the chirp w^(n^2/2).
+The convolution runs by the power-of-two InTimeOOP, where the inverse
+transform is replaced by the forward one of the conjugated data.
+The chirp and the spectrum of the convolution kernel are computed 
+at runtime, so no twiddle factors for N are needed at compile-time.
+They are shared by all objects of the same N, S and precision
+through TwiddleCache (see shared_bluestein).
+\sa BluesteinThreshold
+*/
+template<int_t N, int_t SI, int_t DI, typename VType, int S>
+class Bluestein
+{
+   typedef typename VType::ValueType T;
+   typedef typename InterleavedType<VType>::Result IVType;
+   typedef typename IVType::ValueType BT;
+
+   static const int C = Loki::TypeTraits<T>::isStdFundamental ? 2 : 1;
+   // steps in units of BT
+   static const int_t SI2 = SI*2/C;
+   static const int_t DI2 = DI*2/C;
+
+   static const int_t M = NextPowerOf2<2*N-1>::value;
+   static const int_t M2 = 2*M;
+   typedef typename GroupPowersOf2<typename Factorization<SIntID<M>, SInt>::Result>::Result MFact;
+   typedef typename GetFirstRoot<M,1,IVType::Accuracy>::Result W1;
+   InTimeOOP<M,MFact,IVType,1,W1> m_fft;
+
+   const BT *m_wr, *m_wi;  // shared chirp
+   const BT* m_b;          // shared spectrum of the kernel scaled by 1/M
+   ScratchPool<BT> m_scratch;  // two arrays of M2 per call
+
+   void _apply(const BT* src, BT* dst)
+   {
+      ScratchBuffer<BT> buf(m_scratch);
+      BT* a = buf.get();
+      BT* b = a + M2;
+      for (int_t i=0; i<N; ++i) {
+	const BT re = src[i*SI2], im = src[i*SI2+1];
+	a[2*i]   = re*m_wr[i] - im*m_wi[i];
+	a[2*i+1] = re*m_wi[i] + im*m_wr[i];
+      }
+      for (int_t i=2*N; i<M2; ++i)
+	a[i] = BT(0);
+      m_fft.apply(a, b);
+      
+      // conj(A*B)
+      for (int_t i=0; i<M2; i+=2) {
+	a[i]   =   b[i]*m_b[i]   - b[i+1]*m_b[i+1];
+	a[i+1] = -(b[i]*m_b[i+1] + b[i+1]*m_b[i]);
+      }
+      m_fft.apply(a, b);
+
+      for (int_t i=0; i<N; ++i) {
+	const BT re = b[2*i], im = -b[2*i+1];
+	dst[i*DI2]   = re*m_wr[i] - im*m_wi[i];
+	dst[i*DI2+1] = re*m_wi[i] + im*m_wr[i];
+      }
+   }
+
+public:
+   Bluestein() : m_scratch(2*M2)
+   {
+      m_wr = shared_bluestein<BT>(N, M, S, m_fft);
+      m_wi = m_wr + N;
+      m_b = m_wi + N;
+   }
+
+   void apply(const T* src, T* dst) 
+   { 
+      _apply(reinterpret_cast<const BT*>(src), reinterpret_cast<BT*>(dst));
+   }
+
+   void apply(T* data) 
+   { 
+      _apply(reinterpret_cast<const BT*>(data), reinterpret_cast<BT*>(data));
+   }
+};
+
+
+/// Rader's algorithm for a prime radix
+/*!
+\tparam N length of the data (prime)
+\tparam M step in the data
+\tparam VType value type
+\tparam S sign of the transform: 1 - forward, -1 - backward
+
+The elements 1,...,N-1 are reordered by the powers of a primitive root g mod N,
+so that DFT of the length N turns into a cyclic convolution of the length N-1, 
+which runs by InTimeOOP. The inverse transform of the convolution is replaced 
+by the forward one of the conjugated data. The permutation and the spectrum
+of the kernel are shared through TwiddleCache. The interface is the same as of DFTk_inp,
+so the class is selected instead of it for K > RaderThreshold.
+\sa DFTk_inp_rader, RaderThreshold
+*/
+template<int_t N, int_t M, typename VType>
+class RaderBase
+{
+protected:
+   typedef typename VType::ValueType T;
+   typedef typename InterleavedType<VType>::Result IVType;
+   typedef typename IVType::ValueType BT;
+
+   static const int C = Loki::TypeTraits<T>::isStdFundamental ? 2 : 1;
+   // step in units of BT
+   static const int_t MI = M*2/C;
+   static const int_t L = N-1;
+   static const int_t L2 = 2*L;
+   typedef typename GroupPowersOf2<typename Factorization<SIntID<L>, SInt>::Result>::Result LFact;
+   typedef typename GetFirstRoot<L,1,IVType::Accuracy>::Result W1;
+   InTimeOOP<L,LFact,IVType,1,W1> m_fft;
+
+   const int_t *m_gin, *m_gout;   // shared g^m and g^(-m) mod N
+   const BT* m_b;                 // shared spectrum of the kernel scaled by 1/L
+
+   static int_t primitiveRoot()
+   {
+      typename RuntimeFactorization<>::FactorList factors;
+      RuntimeFactorization<>::apply(L, factors);
+      for (int_t g=2; g<N; ++g) {
+	bool found = true;
+	for (std::size_t f=0; f<factors.size() && found; ++f) {
+	  int_t p = 1;
+	  for (int_t i=0; i<L/factors[f].first; ++i) 
+	    p = (p*g) % N;
+	  found = (p != 1);
+	}
+	if (found) return g;
+      }
+      return 1;
+   }
+
+   /// ws is the step between the twiddles, w0=1 if the element 0 is also scaled
+   template<class LT>
+   void _apply(BT* data, const LT* wr, const LT* wi, const int_t ws, const int_t w0)
+   {
+      BT a[L2], b[L2];
+      BT x0r = data[0], x0i = data[1];
+      if (wr && w0) {
+	const BT t = x0r*wr[0] - x0i*wi[0];
+	x0i = x0r*wi[0] + x0i*wr[0];
+	x0r = t;
+      }
+      BT sr = x0r, si = x0i;
+      for (int_t m=0; m<L; ++m) {
+	const int_t j = m_gin[m];
+	BT re = data[j*MI], im = data[j*MI+1];
+	if (wr) {
+	  const int_t k = (j-1+w0)*ws;
+	  const BT t = re*wr[k] - im*wi[k];
+	  im = re*wi[k] + im*wr[k];
+	  re = t;
+	}
+	a[2*m] = re;
+	a[2*m+1] = im;
+	sr += re;
+	si += im;
+      }
+      m_fft.apply(a, b);
+
+      // conj(A*B)
+      for (int_t i=0; i<L2; i+=2) {
+	a[i]   =   b[i]*m_b[i]   - b[i+1]*m_b[i+1];
+	a[i+1] = -(b[i]*m_b[i+1] + b[i+1]*m_b[i]);
+      }
+      m_fft.apply(a, b);
+
+      data[0] = sr;
+      data[1] = si;
+      for (int_t q=0; q<L; ++q) {
+	const int_t k = m_gout[q]*MI;
+	data[k]   = x0r + b[2*q];
+	data[k+1] = x0i - b[2*q+1];
+      }
+   }
+
+   RaderBase(const int sign)
+   {
+      const TwiddleKey ikey(N, 1, 0, TwiddleRaderIndex);
+      const AlignedArray<int_t>* ti = TwiddleCache<int_t>::find(ikey);
+      if (!ti) {
+	AlignedArray<int_t>* a = new AlignedArray<int_t>(L2);
+	int_t* gin = a->data();
+	int_t* gout = gin + L;
+	const int_t g = primitiveRoot();
+	// g^(-1) = g^(L-1)
+	int_t ginv = 1;
+	for (int_t i=0; i<L-1; ++i) 
+	  ginv = (ginv*g) % N;
+	int_t p = 1, pinv = 1;
+	for (int_t m=0; m<L; ++m) {
+	  gin[m] = p;
+	  gout[m] = pinv;
+	  p = (p*g) % N;
+	  pinv = (pinv*ginv) % N;
+	}
+	ti = TwiddleCache<int_t>::insert(ikey, a);
+      }
+      m_gin = ti->data();
+      m_gout = m_gin + L;
+
+      const TwiddleKey key(N, 1, sign, TwiddleRaderKernel);
+      const AlignedArray<BT>* t = TwiddleCache<BT>::find(key);
+      if (!t) {
+	// kernel w^(g^(-m))
+	BT b[L2];
+	for (int_t m=0; m<L; ++m) {
+	  long double re, im;
+	  direct_root(m_gout[m], N, sign, re, im);
+	  b[2*m]   = static_cast<BT>(re);
+	  b[2*m+1] = static_cast<BT>(im);
+	}
+	AlignedArray<BT>* a = new AlignedArray<BT>(L2);
+	BT* spec = a->data();
+	m_fft.apply(b, spec);
+	for (int_t i=0; i<L2; ++i) 
+	  spec[i] /= L;
+	t = TwiddleCache<BT>::insert(key, a);
+      }
+      m_b = t->data();
+   }
+};
+
+/// Rader's algorithm for a prime radix with the interface of DFTk_inp
+/*!
+\sa RaderBase
+*/
+template<int_t N, int_t M, typename VType, int S>
+class DFTk_inp_rader<N,M,VType,S,true> : public RaderBase<N,M,VType>
+{
+   typedef RaderBase<N,M,VType> Base;
+   typedef typename Base::T T;
+public:
+   DFTk_inp_rader() : Base(S) { }
+
+   void apply(T* data) 
+   { 
+      Base::_apply(data, static_cast<const T*>(0), static_cast<const T*>(0), 1, 0);
+   }
+
+   template<class LT>
+   void apply(T* data, const LT* wr, const LT* wi) 
+   { 
+      Base::_apply(data, wr, wi, 1, 0);
+   }
+
+   template<class LT>
+   void apply_m(T* data, const LT* wr, const LT* wi) 
+   { 
+      Base::_apply(data, wr, wi, 1, 1);
+   }
+};
+
+template<int_t N, int_t M, typename VType, int S>
+class DFTk_inp_rader<N,M,VType,S,false> : public RaderBase<N,M,VType>
+{
+   typedef RaderBase<N,M,VType> Base;
+   typedef typename Base::T CT;
+   typedef typename Base::BT BT;
+public:
+   DFTk_inp_rader() : Base(S) { }
+
+   void apply(CT* data) 
+   { 
+      Base::_apply(reinterpret_cast<BT*>(data), static_cast<const BT*>(0), static_cast<const BT*>(0), 2, 0);
+   }
+
+   void apply(CT* data, const CT* w) 
+   { 
+      const BT* wb = reinterpret_cast<const BT*>(w);
+      Base::_apply(reinterpret_cast<BT*>(data), wb, wb+1, 2, 0);
+   }
+
+   void apply_m(CT* data, const CT* w) 
+   { 
+      const BT* wb = reinterpret_cast<const BT*>(w);
+      Base::_apply(reinterpret_cast<BT*>(data), wb, wb+1, 2, 1);
+   }
+};
+
+
 /// Out-of-place DCT-2
 /**
 \tparam N current transform length
@@ -0,0 +1,290 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gfftcache_h
+#define __gfftcache_h
+
+/** \file
+    \brief Thread-safe cache of the transform objects and the scratch buffers
+*/
+
+#include "sint.h"
+
+#include <cstddef>
+#include <vector>
+
+#include <omp.h>
+
+namespace GFFT {
+
+/// Key of a transform object in PlanCache
+/** The same parameters as in GenerateTransform::CreateTransformObject
+*/
+struct PlanKey
+{
+   int_t n, vtype_id, trans_id, dim, parall_id, place_id;
+
+   PlanKey(const int_t n_, const int_t vtype_id_, const int_t trans_id_,
+           const int_t dim_, const int_t parall_id_, const int_t place_id_)
+   : n(n_), vtype_id(vtype_id_), trans_id(trans_id_),
+     dim(dim_), parall_id(parall_id_), place_id(place_id_) { }
+
+   bool operator==(const PlanKey& k) const
+   {
+      return n == k.n && vtype_id == k.vtype_id && trans_id == k.trans_id
+          && dim == k.dim && parall_id == k.parall_id && place_id == k.place_id;
+   }
+
+   bool operator<(const PlanKey& k) const
+   {
+      if (n != k.n) return n < k.n;
+      if (vtype_id != k.vtype_id) return vtype_id < k.vtype_id;
+      if (trans_id != k.trans_id) return trans_id < k.trans_id;
+      if (dim != k.dim) return dim < k.dim;
+      if (parall_id != k.parall_id) return parall_id < k.parall_id;
+      return place_id < k.place_id;
+   }
+
+   uint_t hash() const
+   {
+      uint_t h = static_cast<uint_t>(n);
+      h = h*31 + static_cast<uint_t>(vtype_id);
+      h = h*31 + static_cast<uint_t>(trans_id);
+      h = h*31 + static_cast<uint_t>(dim);
+      h = h*31 + static_cast<uint_t>(parall_id);
+      h = h*31 + static_cast<uint_t>(place_id);
+      return h ^ (h >> 16);
+   }
+};
+
+
+/// Thread-safe cache of the transform objects
+/*!
+\tparam ObjectType abstract interface of the transforms (AbstractFFT_inp, AbstractFFT_oop)
+\tparam NBuckets number of hash buckets (power of two)
+\tparam Key key of the objects with operator== and hash(), PlanKey by default
+
+The cached objects are owned by the cache and shared between all callers.
+Every bucket is a singly linked list of immutable nodes. A new node is
+inserted at the head of the list under the critical section and published
+after a flush, so that the lookups need no locking.
+The transform objects keep no state between calls of fft(),
+therefore the same object may be used by several threads at once.
+The same cache holds the shared twiddle tables (see TwiddleCache).
+\sa GenerateTransform::GetTransformObject
+*/
+template<class ObjectType, uint_t NBuckets = 256, class Key = PlanKey>
+class PlanCache
+{
+   struct Node {
+      const Key key;
+      ObjectType* const obj;
+      Node* const next;
+      Node(const Key& k, ObjectType* o, Node* n) : key(k), obj(o), next(n) { }
+   };
+
+   Node* m_bucket[NBuckets];
+
+   Node* head(const uint_t b) const
+   {
+      Node* p;
+      #pragma omp atomic read
+      p = m_bucket[b];
+      #pragma omp flush
+      return p;
+   }
+
+   static ObjectType* search(const Node* p, const Key& key)
+   {
+      for (; p; p = p->next)
+	if (p->key == key) return p->obj;
+      return 0;
+   }
+
+   // disable copying, since the objects are owned by the cache
+   PlanCache(const PlanCache&);
+   PlanCache& operator=(const PlanCache&);
+
+public:
+   PlanCache()
+   {
+      for (uint_t i=0; i<NBuckets; ++i)
+	m_bucket[i] = 0;
+   }
+
+   ~PlanCache()
+   {
+      for (uint_t i=0; i<NBuckets; ++i) {
+	Node* p = m_bucket[i];
+	while (p) {
+	  Node* next = p->next;
+	  delete p->obj;
+	  delete p;
+	  p = next;
+	}
+      }
+   }
+
+   /// Returns the cached object or null, if there is no such object
+   ObjectType* find(const Key& key) const
+   {
+      return search(head(key.hash() & (NBuckets-1)), key);
+   }
+
+   /// Inserts the object and returns the cached one
+   /** If another thread has inserted an object with the same key in between,
+       obj is deleted and the object from the cache is returned.
+   */
+   ObjectType* insert(const Key& key, ObjectType* obj)
+   {
+      const uint_t b = key.hash() & (NBuckets-1);
+      ObjectType* found;
+      #pragma omp critical(gfft_plan_cache)
+      {
+	found = search(m_bucket[b], key);
+	if (!found) {
+	  Node* p = new Node(key, obj, m_bucket[b]);
+	  #pragma omp flush
+	  #pragma omp atomic write
+	  m_bucket[b] = p;
+	}
+      }
+      if (found) {
+	delete obj;
+	return found;
+      }
+      return obj;
+   }
+};
+
+
+/// OpenMP lock, which does nothing in a program built without OpenMP
+class OMPLock
+{
+#ifdef _OPENMP
+   omp_lock_t m_lock;
+public:
+   OMPLock() { omp_init_lock(&m_lock); }
+   ~OMPLock() { omp_destroy_lock(&m_lock); }
+   void set() { omp_set_lock(&m_lock); }
+   void unset() { omp_unset_lock(&m_lock); }
+#else
+public:
+   OMPLock() { }
+   void set() { }
+   void unset() { }
+#endif
+private:
+   OMPLock(const OMPLock&);
+   OMPLock& operator=(const OMPLock&);
+};
+
+/// Pool of uninitialized scratch buffers of a plan
+/*!
+\tparam T element type
+
+The transform objects may be called by several threads at once (see PlanCache),
+so the temporary arrays can not be members of the plan.
+Instead, each call takes a buffer from the pool of the plan and returns it
+after the transform. The free list has its own lock in every pool,
+so the calls of different plans don't wait for each other.
+The buffers are allocated once, when the pool is empty,
+and are reused by the next calls without zero-filling.
+The size is set at plan time by resize(). Copies of a pool share nothing,
+they have the same size and allocate their own buffers.
+\sa ScratchBuffer
+*/
+template<typename T>
+class ScratchPool
+{
+   std::vector<T*> m_free;
+   size_t m_size;
+   OMPLock m_lock;
+
+   void clear()
+   {
+      for (size_t i=0; i<m_free.size(); ++i)
+	delete [] m_free[i];
+      m_free.clear();
+   }
+
+public:
+   explicit ScratchPool(const size_t size = 0) : m_size(size) { }
+   ScratchPool(const ScratchPool& p) : m_size(p.m_size) { }
+
+   ScratchPool& operator=(const ScratchPool& p)
+   {
+      if (this != &p) {
+	clear();
+	m_size = p.m_size;
+      }
+      return *this;
+   }
+
+   ~ScratchPool() { clear(); }
+
+   /// Sets the number of elements in each buffer and frees the buffers of the old size
+   void resize(const size_t size)
+   {
+      if (size != m_size) {
+	clear();
+	m_size = size;
+      }
+   }
+
+   size_t size() const { return m_size; }
+
+   /// Takes a buffer of size() elements from the pool or allocates a new one
+   T* acquire()
+   {
+      T* p = 0;
+      m_lock.set();
+      if (!m_free.empty()) {
+	p = m_free.back();
+	m_free.pop_back();
+      }
+      m_lock.unset();
+      return p ? p : new T[m_size];
+   }
+
+   /// Returns the buffer taken by acquire() into the pool
+   void release(T* p)
+   {
+      m_lock.set();
+      m_free.push_back(p);
+      m_lock.unset();
+   }
+};
+
+/// Buffer of a ScratchPool, which is returned to the pool on destruction
+template<typename T>
+class ScratchBuffer
+{
+   ScratchPool<T>& m_pool;
+   T* const m_data;
+
+   ScratchBuffer(const ScratchBuffer&);
+   ScratchBuffer& operator=(const ScratchBuffer&);
+
+public:
+   explicit ScratchBuffer(ScratchPool<T>& pool) : m_pool(pool), m_data(pool.acquire()) { }
+   ~ScratchBuffer() { m_pool.release(m_data); }
+
+   T* get() const { return m_data; }
+   T& operator[](const size_t i) const { return m_data[i]; }
+};
+
+}  //namespace GFFT
+
+#endif /*__gfftcache_h*/
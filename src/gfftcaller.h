@@ -16,6 +16,8 @@
 #define __caller_h
 
 #include "Typelist.h"
+#include "sint.h"
+#include "gfftcache.h"
 
 /** \file
     \brief Caller classes
@@ -79,6 +81,51 @@ struct Caller<Loki::NullType>
 };
 
 
+/// Runs the in-place function apply(T*) of Func on the destination of an out-of-place call
+/** It is used in the out-of-place algorithms, which must transform 
+    the data prepared in the destination array (see IRDFT).
+*/
+template<class Func>
+struct InPlaceOnDst
+{
+   template<typename T>
+   void apply(T* data) {
+      obj_.apply(data);
+   }
+
+   template<typename T1, typename T2>
+   void apply(const T1*, T2* dst) {
+      obj_.apply(dst);
+   }
+
+private:
+   Func obj_;
+};
+
+
+/// Runs Prep from the source into a temporary array of Len elements and Func from it into the destination
+/** It is used in the out-of-place algorithms, which prepare the data
+    before an out-of-place transform without modifying the source (see IRDFT).
+    The temporary arrays are taken from the pool of the object.
+*/
+template<class Prep, class Func, typename T, int_t Len>
+struct ThroughTemp
+{
+   ThroughTemp() : tmp_(Len) { }
+
+   void apply(const T* src, T* dst) {
+      ScratchBuffer<T> tmp(tmp_);
+      prep_.apply(src, tmp.get());
+      obj_.apply(tmp.get(), dst);
+   }
+
+private:
+   Prep prep_;
+   Func obj_;
+   ScratchPool<T> tmp_;
+};
+
+
 /** \class {GFFT::StaticCaller}
 \brief Calls static member function apply() in every type of the typelist
 
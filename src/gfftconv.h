@@ -0,0 +1,320 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gfftconv_h
+#define __gfftconv_h
+
+/** \file
+    \brief Fast convolution and correlation of complex sequences
+
+    The circular, linear and streaming convolutions are computed by
+    the transforms of GenerateTransform with the block size chosen
+    from its compiled lengths.
+*/
+
+#include "gfftpolicy.h"
+#include "gfftcache.h"
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace GFFT {
+
+/// Operation of Convolution
+enum ConvOperation { CONVOLUTION = 0, CORRELATION = 1 };
+
+/// Block method of the streaming Convolution
+enum ConvMethod { OVERLAP_SAVE = 0, OVERLAP_ADD = 1 };
+
+
+/// Values of the integral types from NList
+template<class NList>
+struct ListValues;
+
+template<>
+struct ListValues<Loki::NullType> {
+   static void apply(std::vector<int_t>&) { }
+};
+
+template<class H, class Tail>
+struct ListValues<Loki::Typelist<H,Tail> > {
+   static void apply(std::vector<int_t>& v)
+   {
+      const int_t n = H::value;   // not bound to the reference directly
+      v.push_back(n);
+      ListValues<Tail>::apply(v);
+   }
+};
+
+
+/// Convolution and correlation of complex sequences with a fixed kernel
+/*!
+\tparam TransformSet GenerateTransform containing the DFT of VType
+\tparam VType value type of the sequences
+
+The spectrum of the kernel is computed once at construction.
+Only the forward DFT is used: the inverse transform is
+conj(DFT(conj(Z)))/n, where the conjugation and the scaling by 1/n
+are fused into the pointwise multiplication with the stored kernel spectrum
+and into the storing of the result.
+
+The FFT length n is the compiled length of TransformSet, which minimizes
+the cost n*log(n) per output element of a block, n-klen+1.
+If there is no compiled length from klen, the power of two from 2*klen
+is planned at runtime.
+
+The linear convolution y[t] = sum_j h[j] x[t-j], t = 0,...,xlen+klen-2, is computed
+by the overlap-save blocks, which are distributed between the threads.
+The correlation y[t] = sum_j conj(h[j]) x[t+j-klen+1] is the convolution
+with the reversed conjugated kernel, so the zero lag is at t = klen-1.
+The streaming functions process() and flush() compute the same linear convolution
+of the data coming in chunks of any size without delay. The overlap-save method keeps
+the last klen-1 input elements, the overlap-add one the last klen-1 partial outputs.
+All the lengths are counted in complex elements.
+
+Usage:
+\code
+typedef GenerateTransform<NList, GFFT::COMPLEX_DOUBLE, GFFT::DFT> TransformSet;
+TransformSet gfft;
+GFFT::Convolution<TransformSet, GFFT::COMPLEX_DOUBLE> conv(gfft, h, klen);
+conv.linear(x, xlen, y);     // xlen+klen-1 elements
+conv.process(x, len, y);     // len elements
+conv.flush(y);               // klen-1 elements
+\endcode
+*/
+template<class TransformSet, class VType>
+class Convolution
+{
+   typedef typename VType::ValueType T;
+   typedef typename InterleavedType<VType>::Result::ValueType BT;
+   typedef typename TransformSet::ObjectType ObjectType;
+   typedef typename TransformSet::PlaceType Place;
+
+   const int_t m_klen, m_n, m_block;
+   const ConvOperation m_op;
+   const ConvMethod m_method;
+   const int m_nthreads;
+   ObjectType* m_fft;
+   std::vector<BT> m_spec;   // conj(H)/n
+   std::vector<BT> m_hist;   // klen-1 last inputs or partial outputs
+   const std::vector<BT> m_zeros;   // history of a new stream, klen-1 zeros
+   ScratchPool<BT> m_buf;   // two arrays of n per block
+
+   static T* cast(BT* p) { return reinterpret_cast<T*>(p); }
+
+   // forward DFT of a into a or b, returns the pointer to the result
+   static BT* transform(AbstractFFT_inp<T>* obj, BT* a, BT*) { obj->fft(cast(a)); return a; }
+   static BT* transform(AbstractFFT_oop<T>* obj, BT* a, BT* b) { obj->fft(cast(a), cast(b)); return b; }
+
+   static int_t choose(TransformSet& set, const int_t klen)
+   {
+      std::vector<int_t> lens;
+      ListValues<typename TransformSet::LengthList>::apply(lens);
+      int_t best = 0;
+      double best_cost = 0;
+      for (std::size_t i=0; i<lens.size(); ++i) {
+	const int_t n = lens[i];
+	if (n < klen || !set.dispatch.find(n, VType::ID, DFT::ID, 1, 0, Place::ID))
+	  continue;
+	const double cost = n*std::log(static_cast<double>(n))/(n - klen + 1);
+	if (!best || cost < best_cost) {
+	  best = n;
+	  best_cost = cost;
+	}
+      }
+      if (!best)
+	for (best = 1; best < 2*klen; best *= 2) ;
+      return best;
+   }
+
+   // circular convolution of the n elements in a with the kernel, the result is in a or b
+   BT* circular(BT* a, BT* b)
+   {
+      BT* x = transform(m_fft, a, b);
+      BT* z = (x == a) ? b : a;
+      // conj(X*H)/n = conj(X)*m_spec
+      for (int_t i=0; i<2*m_n; i+=2) {
+	z[i]   = x[i]*m_spec[i]   + x[i+1]*m_spec[i+1];
+	z[i+1] = x[i]*m_spec[i+1] - x[i+1]*m_spec[i];
+      }
+      return transform(m_fft, z, x);
+   }
+
+   // y[0,...,len) from the input stream (hist[0,...,klen-1), x[0,...,xlen), 0, 0, ...)
+   void ols(const BT* hist, const BT* x, const int_t xlen, BT* y, const int_t len)
+   {
+      const int_t k1 = m_klen - 1;
+      const int_t nb = (len + m_block - 1)/m_block;
+      #pragma omp parallel num_threads(m_nthreads) if(m_nthreads > 1 && nb > 1)
+      {
+	// every thread transforms its blocks in its own pair of buffers
+	ScratchBuffer<BT> buf(m_buf);
+	BT* a = buf.get();
+	BT* b = a + 2*m_n;
+	#pragma omp for schedule(static)
+	for (int_t blk=0; blk<nb; ++blk) {
+	  const int_t t0 = blk*m_block;
+	  const int_t nt = std::min(m_block, len - t0);
+	  std::fill(a, a + 2*m_n, BT(0));
+	  for (int_t i=0; i<k1+nt; ++i) {
+	    const int_t s = t0 + i;   // position in the stream
+	    const BT* e = (s < k1) ? hist + 2*s : ((s-k1 < xlen) ? x + 2*(s-k1) : 0);
+	    if (e) {
+	      a[2*i]   = e[0];
+	      a[2*i+1] = e[1];
+	    }
+	  }
+	  const BT* c = circular(a, b);
+	  for (int_t i=0; i<nt; ++i) {
+	    y[2*(t0+i)]   =  c[2*(k1+i)];
+	    y[2*(t0+i)+1] = -c[2*(k1+i)+1];
+	  }
+	}
+      }
+   }
+
+   void ola(const BT* x, const int_t len, BT* y)
+   {
+      const int_t k1 = m_klen - 1;
+      ScratchBuffer<BT> buf(m_buf);
+      BT* a = buf.get();
+      BT* b = a + 2*m_n;
+      for (int_t t0=0; t0<len; t0+=m_block) {
+	const int_t nt = std::min(m_block, len - t0);
+	std::fill(a, a + 2*m_n, BT(0));
+	std::copy(x + 2*t0, x + 2*(t0+nt), a);
+	const BT* c = circular(a, b);
+	// the block contributes to nt+k1 outputs, the first nt of them are complete,
+	// the others are kept in m_hist, which is read before it is overwritten
+	for (int_t i=0; i<nt+k1; ++i) {
+	  const BT re = c[2*i], im = -c[2*i+1];
+	  const BT hr = (i < k1) ? m_hist[2*i] : 0;
+	  const BT hi = (i < k1) ? m_hist[2*i+1] : 0;
+	  if (i < nt) {
+	    y[2*(t0+i)]   = re + hr;
+	    y[2*(t0+i)+1] = im + hi;
+	  }
+	  else {
+	    m_hist[2*(i-nt)]   = re + hr;
+	    m_hist[2*(i-nt)+1] = im + hi;
+	  }
+	}
+      }
+   }
+
+   // disable copying, since the transform object is owned
+   Convolution(const Convolution&);
+   Convolution& operator=(const Convolution&);
+
+public:
+   /// Computes the spectrum of the kernel h of klen elements
+   /** \param n FFT length or 0 to choose it automatically;
+                the circular convolution has the length n
+       \param parall_id parallelization id of the threads, which share the blocks
+                        (OpenMP<NT>::ID = NT-1); the transforms are serial
+   */
+   Convolution(TransformSet& set, const T* h, const int_t klen,
+               const ConvOperation op = CONVOLUTION, const ConvMethod method = OVERLAP_SAVE,
+               const int_t parall_id = 0, const int_t n = 0)
+   : m_klen(klen), m_n(n ? n : choose(set, klen)), m_block(m_n - klen + 1),
+     m_op(op), m_method(method), m_nthreads(static_cast<int>(parall_id) + 1),
+     m_fft(set.CreateTransformObject(m_n, VType::ID, DFT::ID, 1, 0, Place::ID)),
+     m_spec(2*m_n, BT(0)), m_hist(2*std::max(klen-1, int_t(1)), BT(0)),
+     m_zeros(m_hist.size(), BT(0)), m_buf(4*m_n)
+   {
+      const BT* hb = reinterpret_cast<const BT*>(h);
+      for (int_t j=0; j<klen; ++j) {
+	const int_t i = (op == CORRELATION) ? klen-1-j : j;
+	m_spec[2*i]   = hb[2*j];
+	m_spec[2*i+1] = (op == CORRELATION) ? -hb[2*j+1] : hb[2*j+1];
+      }
+      std::vector<BT> tmp(2*m_n);
+      const BT* spec = transform(m_fft, &m_spec[0], &tmp[0]);
+      for (int_t i=0; i<2*m_n; i+=2) {
+	tmp[i]   =  spec[i]/m_n;
+	tmp[i+1] = -spec[i+1]/m_n;
+      }
+      m_spec.swap(tmp);
+   }
+
+   ~Convolution() { delete m_fft; }
+
+   /// FFT length and the length of the circular convolution
+   int_t length() const { return m_n; }
+
+   /// Number of the output elements of a block
+   int_t block() const { return m_block; }
+
+   /// Circular convolution of n elements
+   /** The correlation is shifted, so that the zero lag is at y[0].
+   */
+   void circular(const T* x, T* y)
+   {
+      ScratchBuffer<BT> buf(m_buf);
+      BT* a = buf.get();
+      const BT* xb = reinterpret_cast<const BT*>(x);
+      std::copy(xb, xb + 2*m_n, a);
+      const BT* c = circular(a, a + 2*m_n);
+      BT* yb = reinterpret_cast<BT*>(y);
+      const int_t shift = (m_op == CORRELATION) ? m_klen-1 : 0;
+      for (int_t i=0; i<m_n; ++i) {
+	const int_t k = (i + shift) % m_n;
+	yb[2*i]   =  c[2*k];
+	yb[2*i+1] = -c[2*k+1];
+      }
+   }
+
+   /// Linear convolution of xlen elements into xlen+klen-1 elements
+   /** The streaming state is not changed.
+   */
+   void linear(const T* x, const int_t xlen, T* y)
+   {
+      ols(&m_zeros[0], reinterpret_cast<const BT*>(x), xlen, reinterpret_cast<BT*>(y), xlen + m_klen - 1);
+   }
+
+   /// Streaming convolution of the next len input elements into len output elements
+   void process(const T* x, const int_t len, T* y)
+   {
+      const BT* xb = reinterpret_cast<const BT*>(x);
+      BT* yb = reinterpret_cast<BT*>(y);
+      if (m_method == OVERLAP_ADD) {
+	ola(xb, len, yb);
+	return;
+      }
+      ols(&m_hist[0], xb, len, yb, len);
+      // keep the last klen-1 elements of the stream
+      const int_t k1 = m_klen - 1;
+      if (len >= k1)
+	std::copy(xb + 2*(len-k1), xb + 2*len, m_hist.begin());
+      else {
+	std::copy(m_hist.begin() + 2*len, m_hist.begin() + 2*k1, m_hist.begin());
+	std::copy(xb, xb + 2*len, m_hist.begin() + 2*(k1-len));
+      }
+   }
+
+   /// Returns the last klen-1 output elements of the stream and resets it
+   void flush(T* y)
+   {
+      process(reinterpret_cast<const T*>(&m_zeros[0]), m_klen - 1, y);
+      reset();
+   }
+
+   /// Starts a new stream
+   void reset() { std::fill(m_hist.begin(), m_hist.end(), BT(0)); }
+};
+
+}  //namespace GFFT
+
+#endif /*__gfftconv_h*/
@@ -0,0 +1,176 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gfftcpu_h
+#define __gfftcpu_h
+
+/** \file
+    \brief Identification of the processor, its instruction set and caches
+*/
+
+#include "sint.h"
+
+#include <stdint.h>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define GFFT_CPUID_MSVC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+#include <cpuid.h>
+#define GFFT_CPUID_GNU
+#endif
+
+namespace GFFT {
+
+/// Instruction set levels of the vectorized kernels
+enum ISALevel { ISA_GENERIC = 0, ISA_SSE2 = 1, ISA_AVX2 = 2, ISA_AVX512 = 3 };
+
+/// Executes the instruction cpuid, returns false if it is not available
+/** \param subleaf value of ecx for the leaves with subleaves (e.g. 7)
+*/
+inline bool cpuid(const unsigned int leaf, unsigned int reg[4], const unsigned int subleaf = 0)
+{
+#if defined(GFFT_CPUID_MSVC)
+   int r[4];
+   __cpuid(r, static_cast<int>(leaf & 0x80000000u));
+   if (static_cast<unsigned int>(r[0]) < leaf) {
+     reg[0] = reg[1] = reg[2] = reg[3] = 0;
+     return false;
+   }
+   __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+   for (int i=0; i<4; ++i)
+     reg[i] = static_cast<unsigned int>(r[i]);
+   return true;
+#elif defined(GFFT_CPUID_GNU)
+   if (__get_cpuid_max(leaf & 0x80000000u, 0) < leaf) {
+     reg[0] = reg[1] = reg[2] = reg[3] = 0;
+     return false;
+   }
+   __cpuid_count(leaf, subleaf, reg[0], reg[1], reg[2], reg[3]);
+   return true;
+#else
+   (void)leaf; (void)subleaf;
+   reg[0] = reg[1] = reg[2] = reg[3] = 0;
+   return false;
+#endif
+}
+
+/// Register state enabled by the operating system (xgetbv 0)
+inline uint64_t xcr0()
+{
+#if defined(GFFT_CPUID_MSVC)
+   return _xgetbv(0);
+#elif defined(GFFT_CPUID_GNU)
+   unsigned int lo, hi;
+   __asm__ __volatile__ ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+   return (static_cast<uint64_t>(hi) << 32) | lo;
+#else
+   return 0;
+#endif
+}
+
+/// The highest ISALevel supported by the processor and the operating system
+/** ISA_AVX2 requires AVX, AVX2 and FMA, ISA_AVX512 requires AVX512F in addition;
+    the wide registers must be saved by the operating system (XCR0).
+*/
+inline int cpu_isa()
+{
+   unsigned int reg[4];
+   if (!cpuid(1, reg))
+     return ISA_GENERIC;
+   if (!(reg[3] & (1u << 26)))    // SSE2
+     return ISA_GENERIC;
+
+   const bool osxsave = (reg[2] & (1u << 27)) != 0;
+   const bool avx = (reg[2] & (1u << 28)) != 0;
+   const bool fma = (reg[2] & (1u << 12)) != 0;
+   if (!osxsave || !avx || !fma)
+     return ISA_SSE2;
+   const uint64_t xcr = xcr0();
+   if ((xcr & 0x6) != 0x6)        // XMM and YMM state
+     return ISA_SSE2;
+   if (!cpuid(7, reg, 0) || !(reg[1] & (1u << 5)))    // AVX2
+     return ISA_SSE2;
+   if (!(reg[1] & (1u << 16)) || (xcr & 0xE6) != 0xE6)  // AVX512F, opmask and ZMM state
+     return ISA_AVX2;
+   return ISA_AVX512;
+}
+
+/// 32-bit signature of the processor
+/** The hash (FNV-1a) of the vendor string, family, model and stepping
+    and the brand string. The signature is 0, if the processor can not
+    be identified. It is used to key the measured plan variants in PlanWisdom,
+    because the fastest variant depends on the machine.
+*/
+inline uint32_t cpu_signature()
+{
+   uint32_t h = 2166136261u;
+   unsigned int reg[4];
+   if (!cpuid(0, reg))
+     return 0;
+
+   const unsigned int vendor[3] = { reg[1], reg[3], reg[2] };
+   const unsigned int max_leaf = reg[0];
+   unsigned int words[4+3+12];
+   int nw = 0;
+   for (int i=0; i<3; ++i)
+     words[nw++] = vendor[i];
+
+   if (max_leaf >= 1 && cpuid(1, reg))
+     words[nw++] = reg[0];     // family, model, stepping
+
+   // brand string
+   if (cpuid(0x80000000u, reg) && reg[0] >= 0x80000004u) {
+     for (unsigned int leaf = 0x80000002u; leaf <= 0x80000004u; ++leaf) {
+       cpuid(leaf, reg);
+       for (int i=0; i<4; ++i)
+	 words[nw++] = reg[i];
+     }
+   }
+
+   for (int i=0; i<nw; ++i)
+     for (int b=0; b<4; ++b) {
+       h ^= (words[i] >> (8*b)) & 0xFFu;
+       h *= 16777619u;
+     }
+   return h;
+}
+
+/// Size in bytes of the data or unified cache of the given level, 0 if it can not be determined
+/** The deterministic cache parameters are read from cpuid leaf 4 (Intel)
+    or 0x8000001D (AMD).
+*/
+inline int_t cpu_cache_size(const unsigned int level)
+{
+   const unsigned int leaves[2] = { 4u, 0x8000001Du };
+   unsigned int reg[4];
+   for (int l=0; l<2; ++l)
+     for (unsigned int sub=0; sub<16 && cpuid(leaves[l], reg, sub); ++sub) {
+       const unsigned int type = reg[0] & 0x1F;    // 0: no more caches, 2: instruction cache
+       if (type == 0)
+	 break;
+       if (type != 2 && ((reg[0] >> 5) & 0x7) == level) {
+	 const int_t ways = ((reg[1] >> 22) & 0x3FF) + 1;
+	 const int_t partitions = ((reg[1] >> 12) & 0x3FF) + 1;
+	 const int_t line = (reg[1] & 0xFFF) + 1;
+	 const int_t sets = static_cast<int_t>(reg[2]) + 1;
+	 return ways*partitions*line*sets;
+       }
+     }
+   return 0;
+}
+
+}  //namespace GFFT
+
+#endif /*__gfftcpu_h*/
@@ -0,0 +1,268 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gfftdispatch_h
+#define __gfftdispatch_h
+
+/** \file
+    \brief Dense dispatch table of the generated transforms
+*/
+
+#include "Typelist.h"
+
+#include "sint.h"
+
+namespace GFFT {
+
+/// Wraps a single type into Typelist, a Typelist remains unchanged
+template<class T>
+struct AsTypelist {
+   typedef Loki::Typelist<T,Loki::NullType> Result;
+};
+
+template<class H, class T>
+struct AsTypelist<Loki::Typelist<H,T> > {
+   typedef Loki::Typelist<H,T> Result;
+};
+
+
+/// Maximum of H::ID over the types H in TList
+template<class TList>
+struct MaxID;
+
+template<class H>
+struct MaxID<Loki::Typelist<H,Loki::NullType> > {
+   static const int_t value = H::ID;
+};
+
+template<class H, class T>
+struct MaxID<Loki::Typelist<H,T> > {
+   static const int_t Next = MaxID<T>::value;
+   static const int_t value = (static_cast<int_t>(H::ID) > Next) ? static_cast<int_t>(H::ID) : Next;
+};
+
+
+/// Checks, if a value from NList different from V has the same residue modulo P
+template<class NList, int_t V, int_t P>
+struct HasResidue;
+
+template<int_t V, int_t P>
+struct HasResidue<Loki::NullType,V,P> {
+   static const bool value = false;
+};
+
+template<class H, class T, int_t V, int_t P>
+struct HasResidue<Loki::Typelist<H,T>,V,P> {
+   static const bool value = ((H::value != V) && (H::value % P == V % P))
+                          || HasResidue<T,V,P>::value;
+};
+
+/// Checks, if the different values from NList have different residues modulo P
+template<class NList, int_t P>
+struct DistinctResidues;
+
+template<int_t P>
+struct DistinctResidues<Loki::NullType,P> {
+   static const bool value = true;
+};
+
+template<class H, class T, int_t P>
+struct DistinctResidues<Loki::Typelist<H,T>,P> {
+   static const bool value = !HasResidue<T,H::value,P>::value && DistinctResidues<T,P>::value;
+};
+
+/// The least modulus P >= Length<NList>, which is a perfect hash of the values from NList
+/** The search always stops, since any P greater than the maximum value is perfect
+*/
+template<class NList,
+int_t P = Loki::TL::Length<NList>::value,
+bool C = DistinctResidues<NList,P>::value>
+struct PerfectHashModulus {
+   static const int_t value = PerfectHashModulus<NList,P+1>::value;
+};
+
+template<class NList, int_t P>
+struct PerfectHashModulus<NList,P,true> {
+   static const int_t value = P;
+};
+
+
+/// Maps the IDs of the types from TList onto their positions in TList
+template<class TList>
+class DenseIndex
+{
+   static const int_t MaxId = MaxID<TList>::value;
+   int_t m_index[MaxId+1];
+
+   template<class L, int_t I>
+   struct Init;
+
+   template<int_t I>
+   struct Init<Loki::NullType,I> {
+      static void apply(int_t*) { }
+   };
+
+   template<class H, class T, int_t I>
+   struct Init<Loki::Typelist<H,T>,I> {
+      static void apply(int_t* index)
+      {
+	index[H::ID] = I;
+	Init<T,I+1>::apply(index);
+      }
+   };
+
+public:
+   static const int_t Length = Loki::TL::Length<TList>::value;
+
+   DenseIndex()
+   {
+      for (int_t i=0; i<=MaxId; ++i)
+	m_index[i] = -1;
+      Init<TList,0>::apply(m_index);
+   }
+
+   /// Position of the type with the given id or -1
+   int_t operator()(const int_t id) const
+   {
+      return (id >= 0 && id <= MaxId) ? m_index[id] : -1;
+   }
+};
+
+
+/// Dense dispatch table from the transform parameters to the functions Create()
+/*!
+\tparam TransList Typelist of generated Transform classes
+\tparam NList list of transform lengths
+\tparam VList, TList, DimList, ParallList, PlaceList lists of value types, transform types,
+        dimensions, parallelizations and places
+\tparam VarList list of plan variants
+\tparam ObjectType abstract interface of the transforms
+
+The transform length n is mapped onto the slot n % P, where the modulus P is
+the compile-time perfect hash of NList (PerfectHashModulus). The other parameters
+are mapped onto their positions in the parameter lists by DenseIndex.
+So the lookup takes constant time and does not depend on the values of IDs.
+The plan variant is given by its position in VarList, where
+the position 0 is the default variant.
+The table is filled once per GenerateTransform type.
+\sa GenerateTransform
+*/
+template<class TransList, class NList, class VList, class TList,
+         class DimList, class ParallList, class PlaceList, class VarList, class ObjectType>
+class TransformTable
+{
+public:
+   typedef ObjectType* (*CreateFunc)();
+
+private:
+   static const int_t P = PerfectHashModulus<NList>::value;
+   static const int_t LV = Loki::TL::Length<VList>::value;
+   static const int_t LT = Loki::TL::Length<TList>::value;
+   static const int_t LD = Loki::TL::Length<DimList>::value;
+   static const int_t LP = Loki::TL::Length<ParallList>::value;
+   static const int_t LPl = Loki::TL::Length<PlaceList>::value;
+   static const int_t LVar = Loki::TL::Length<VarList>::value;
+   static const int_t Size = P*LV*LT*LD*LP*LPl*LVar;
+
+   DenseIndex<VList> m_vtype;
+   DenseIndex<TList> m_trans;
+   DenseIndex<DimList> m_dim;
+   DenseIndex<ParallList> m_parall;
+   DenseIndex<PlaceList> m_place;
+   DenseIndex<VarList> m_variant;
+
+   int_t m_len[P];
+   CreateFunc m_func[Size];
+
+   static int_t index(const int_t slot, const int_t v, const int_t t,
+                      const int_t d, const int_t pa, const int_t pl, const int_t var)
+   {
+      return (((((slot*LV + v)*LT + t)*LD + d)*LP + pa)*LPl + pl)*LVar + var;
+   }
+
+   template<class L, int_t Dummy = 0>
+   struct Init;
+
+   template<int_t Dummy>
+   struct Init<Loki::NullType,Dummy> {
+      static void apply(TransformTable&) { }
+   };
+
+   template<class H, class Tail, int_t Dummy>
+   struct Init<Loki::Typelist<H,Tail>,Dummy> {
+      static void apply(TransformTable& t)
+      {
+	const int_t slot = H::Len % P;
+	t.m_len[slot] = H::Len;
+	t.m_func[index(slot, Loki::TL::IndexOf<VList,typename H::ValueType>::value,
+	                     Loki::TL::IndexOf<TList,typename H::TransformType>::value,
+	                     Loki::TL::IndexOf<DimList,typename H::DimType>::value,
+	                     Loki::TL::IndexOf<ParallList,typename H::ParallType>::value,
+	                     Loki::TL::IndexOf<PlaceList,typename H::PlaceType>::value,
+	                     Loki::TL::IndexOf<VarList,typename H::VariantType>::value)] = H::Create;
+	Init<Tail>::apply(t);
+      }
+   };
+
+public:
+   /// Number of plan variants and their maximum PlanVariant::ID
+   static const int_t NumVariants = LVar;
+   static const int_t MaxVariantID = MaxID<VarList>::value;
+
+   TransformTable();
+
+   /// Position of the plan variant with the given PlanVariant::ID in VarList or -1
+   int_t variant(const int_t variant_id) const
+   {
+      return m_variant(variant_id);
+   }
+
+   /// Returns the function Create() of the transform or null, if it was not generated
+   /** \param var position of the plan variant in VarList
+   */
+   CreateFunc find(const int_t n, const int_t vtype_id, const int_t trans_id,
+                   const int_t dim, const int_t parall_id, const int_t place_id,
+                   const int_t var = 0) const
+   {
+      if (n < 1) return 0;
+      const int_t slot = n % P;
+      if (m_len[slot] != n) return 0;
+      const int_t v = m_vtype(vtype_id);
+      const int_t t = m_trans(trans_id);
+      const int_t d = m_dim(dim-1);
+      const int_t pa = m_parall(parall_id);
+      const int_t pl = m_place(place_id);
+      if (v < 0 || t < 0 || d < 0 || pa < 0 || pl < 0) return 0;
+      if (var < 0 || var >= LVar) return 0;
+      return m_func[index(slot, v, t, d, pa, pl, var)];
+   }
+};
+
+// The constructor instantiates all the transforms of the table.
+// It is defined out of the class, so that it is not inline and
+// an explicit instantiation declaration (see gfftlib.h) suppresses it.
+template<class TransList, class NList, class VList, class TList,
+         class DimList, class ParallList, class PlaceList, class VarList, class ObjectType>
+TransformTable<TransList,NList,VList,TList,DimList,ParallList,PlaceList,VarList,ObjectType>::TransformTable()
+{
+   for (int_t i=0; i<P; ++i)
+     m_len[i] = 0;
+   for (int_t i=0; i<Size; ++i)
+     m_func[i] = 0;
+   Init<TransList>::apply(*this);
+}
+
+}  //namespace GFFT
+
+#endif /*__gfftdispatch_h*/
@@ -21,6 +21,10 @@
 
 #include "sint.h"
 
+#include <vector>
+#include <utility>
+#include <cassert>
+
 namespace GFFT {
 
 
@@ -135,6 +139,66 @@ struct Factorization<SIntID<1>, IntHolder, Loki::Typelist<H,Tail>, AddPower> {
 };
 
 
+/// Runtime counterpart of Factorization
+/**
+\tparam StartList list of primes tried first (InitialPrimesList by default)
+
+Used to plan transform lengths, which are known at runtime only.
+The trial division follows the same order as Factorization:
+primes from StartList first, then candidates 6k+1 and 6k+5.
+The factors are returned as pairs (prime, power).
+*/
+template<typename StartList = InitialPrimesList>
+struct RuntimeFactorization;
+
+template<>
+struct RuntimeFactorization<Loki::NullType>
+{
+  typedef std::vector<std::pair<int_t,int_t> > FactorList;
+
+  static void divide(int_t& n, const int_t f, FactorList& factors)
+  {
+    int_t p = 0;
+    while (n > 1 && n % f == 0) {
+      n /= f;
+      ++p;
+    }
+    if (p > 0)
+      factors.push_back(std::make_pair(f, p));
+  }
+
+  static void trial(int_t& n, FactorList& factors)
+  {
+    for (int_t k = 2; (6*k+1)*(6*k+1) <= n; ++k) {
+      divide(n, 6*k+1, factors);
+      divide(n, 6*k+5, factors);
+    }
+    if (n > 1) {
+      factors.push_back(std::make_pair(n, static_cast<int_t>(1)));
+      n = 1;
+    }
+  }
+};
+
+template<typename H, typename Tail>
+struct RuntimeFactorization<Loki::Typelist<H,Tail> >
+{
+  typedef std::vector<std::pair<int_t,int_t> > FactorList;
+
+  static void apply(int_t n, FactorList& factors)
+  {
+    factors.clear();
+    trial(n, factors);
+  }
+
+  static void trial(int_t& n, FactorList& factors)
+  {
+    RuntimeFactorization<Loki::NullType>::divide(n, H::value, factors);
+    RuntimeFactorization<Tail>::trial(n, factors);
+  }
+};
+
+
 template<int_t M, int_t P>
 struct PowerHolder;
 
@@ -195,6 +259,103 @@ struct ExtractFactor<N, Loki::NullType, Accum, false>
   static const int_t value = Accum;
 };
 
+
+/// Digit-reversed order of the factors of K
+/*!
+\tparam K product of the factors
+\tparam KFact factorization of K
+
+value(i) is the position of the element i after the reordering by the digits
+of KFact, which is the order of the data in the in-place algorithms.
+*/
+template<int_t K, typename KFact>
+struct Permutation;
+
+template<int_t K, int_t N, int_t P, typename Tail>
+struct Permutation<K, Loki::Typelist<Pair<SInt<N>,SInt<P> >,Tail> >
+{
+  static const int_t M = K/N;   // K = M*N
+  typedef Permutation<K/N, Loki::Typelist<Pair<SInt<N>,SInt<P-1> >,Tail> > Next;
+  static int_t value(const int_t ii)
+  {
+    assert(ii >= 0 && ii < K);
+    return (ii%N)*M + Next::value(ii/N);
+  }
+};
+
+template<int_t K, int_t N, typename Tail>
+struct Permutation<K, Loki::Typelist<Pair<SInt<N>,SInt<0> >,Tail> >
+: public Permutation<K, Tail> {};
+
+// template<>
+// struct Permutation<4, Loki::Typelist<Pair<SInt<2>,SInt<2> >,Loki::NullType> >
+// {
+//   static int_t value(const int_t ii) { return ii; }
+// };
+
+template<int_t K>
+struct Permutation<K, Loki::NullType>
+{
+  static int_t value(const int_t ii) { return ii; }
+};
+
+/// Position of the element i in the input of the in-place kernel DFTk_inp<K>
+/** The kernels of K = 2^r (r > 1) take their input in bit-reversed order,
+    which is the one of the blocks in the data reordered by GFFTswap2,
+    the other radices in natural order.
+*/
+template<int_t K, bool Pow2 = (K > 2) && ((K & (K-1)) == 0)>
+struct KernelInputOrder 
+: public Permutation<K, Loki::Typelist<Pair<SInt<2>, SInt<IsMultipleOf<K,2>::value> >, Loki::NullType> > {};
+
+template<int_t K>
+struct KernelInputOrder<K,false> : public Permutation<K, Loki::NullType> {};
+
+
+/// Default largest radix of the grouped powers of two
+/** The kernels of the radices 8 and 16 hold more elements than there are
+    vector registers in the scaled stages, so the radix 4 is the default.
+    The larger radices are selected by the plan variant (see PlanVariant).
+*/
+static const int_t Power2Radix = 4;
+
+/// Groups the powers of two of a factorization into the radices 2^r up to Radix
+/*!
+\tparam NFact factorization (see Factorization)
+\tparam Radix largest radix: 4, 8 or 16
+
+Pair<SInt<2>,SInt<P> > is replaced by Pair<SInt<Radix>,SInt<P/r> > followed by 
+the single radix 2^(P%r), Radix = 2^r, the other factors are not changed. 
+The scaled stages of the radices 4, 8 and 16 run the kernels DFTk_inp<4>, <8> and <16>,
+which replace up to four passes of the radix 2 over the data by a single one.
+Their input is in bit-reversed order (KernelInputOrder), so the data of the 
+in-place algorithms are reordered by GFFTswap2 of the original factorization.
+*/
+template<typename NFact, int_t Radix = Power2Radix>
+struct GroupPowersOf2;
+
+template<int_t Radix>
+struct GroupPowersOf2<Loki::NullType,Radix> {
+  typedef Loki::NullType Result;
+};
+
+template<typename Head, typename Tail, int_t Radix>
+struct GroupPowersOf2<Loki::Typelist<Head,Tail>,Radix> {
+  typedef Loki::Typelist<Head, typename GroupPowersOf2<Tail,Radix>::Result> Result;
+};
+
+template<int_t P, typename Tail, int_t Radix>
+struct GroupPowersOf2<Loki::Typelist<Pair<SInt<2>,SInt<P> >,Tail>,Radix> {
+  static const int_t PR = IsMultipleOf<Radix,2>::value;
+  static const int_t Q = P/PR;
+  static const int_t R = P%PR;
+  typedef typename GroupPowersOf2<Tail,Radix>::Result Next;
+  typedef typename Loki::Select<(R > 0),
+    Loki::Typelist<Pair<SInt<(1<<R)>,SInt<1> >, Next>, Next>::Result Rest;
+  typedef typename Loki::Select<(Q > 0),
+    Loki::Typelist<Pair<SInt<Radix>,SInt<Q> >, Rest>, Rest>::Result Result;
+};
+
   
 }  //namespace DFT
 
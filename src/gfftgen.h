@@ -23,12 +23,48 @@
 #include "sint.h"
 #include "typelistgen.h"
 #include "gfftparamgroups.h"
+#include "gfftruntime.h"
+#include "gfftguru.h"
+#include "gfftsplit.h"
+#include "gfftcache.h"
+#include "gfftdispatch.h"
+#include "gfftplan.h"
 
 #include "Singleton.h"
+#include "static_check.h"
+
+#include <exception>
+#include <typeinfo>
+#include <vector>
 
 /// Main namespace
 namespace GFFT {
 
+/// Transform object of the dimension Dim
+/** The one-dimensional transform object Exec is used directly.
+    The multi-dimensional transform of the length N in every dimension
+    is built by MultiDimFunction from the serial one-dimensional out-of-place
+    transform, since the rows and columns are distributed between the threads.
+    Only complex-valued transforms (DFT, IDFT) can be multi-dimensional.
+*/
+template<class N, class VType, class Type, class Dim, class Parall, class Place,
+class Variant, class Exec, bool Multi = (Dim::value > 1)>
+struct DimExec {
+   typedef Exec Result;
+};
+
+template<class N, class VType, class Type, class Dim, class Parall, class Place,
+class Variant, class Exec>
+struct DimExec<N,VType,Type,Dim,Parall,Place,Variant,Exec,true> {
+   enum { ComplexOnly = sizeof(Loki::CompileTimeError<(Type::ID == DFT::ID || Type::ID == IDFT::ID)>) };
+
+   typedef typename Serial::template Factor<N,Variant>::Result NFactor;
+   typedef typename Type::template Algorithm<N::value,NFactor,VType,Serial,OUT_OF_PLACE,Variant::MaxRadix>::Result Alg;
+   typedef typename OUT_OF_PLACE::template Function<Caller<Loki::Typelist<Serial,Alg> >, 
+                                                    typename VType::ValueType> Line;
+   typedef MultiDimFunction<N::value,Dim::value,Parall::NParProc,VType,Place,Line> Result;
+};
+
   
 /** \class {GFFT::Transform}
 \brief Generic Fast Fourier transform in-place class
@@ -39,6 +75,7 @@ namespace GFFT {
 \tparam Parall parallelization
 \tparam Decimation in-time or in-frequency: INTIME, INFREQ
 \tparam FactoryPolicy policy used to create an object factory. Don't define it explicitely, if unsure
+\tparam Variant plan variant (see PlanVariant), which defines the order of factors and the largest radix
 
 Use this class only, if you need transform of a single fixed type and length.
 Otherwise, rely on template class GenerateTransform
@@ -49,12 +86,13 @@ class Type,                    // DFT, IDFT, RDFT, IRDFT
 class Dim,
 class Parall,
 class Place,              // IN_PLACE, OUT_OF_PLACE
-id_t IDN = N::ID>
+id_t IDN = N::ID,
+class Variant = DefaultPlan>
 class Transform 
 {
    typedef typename VType::ValueType T;
    
-   typedef typename Parall::template Factor<N>::Result NFactor;
+   typedef typename Parall::template Factor<N,Variant>::Result NFactor;
    //static const int_t NR = PrecomputeRoots;
    //typedef ExtractFactor<NR, NFactor> EF;
    //static const int_t NN = N::value/NFactor::Head::first::value;
@@ -62,16 +100,23 @@ class Transform
    
    //typedef Loki::SingletonHolder<RootsHolder<NR,typename EF::Result,VType,Type::Sign> > Twiddles;
 
-   typedef typename Type::template Algorithm<N::value,NFactor,VType,Parall,Place>::Result Alg;
+   typedef typename Type::template Algorithm<N::value,NFactor,VType,Parall,Place,Variant::MaxRadix>::Result Alg;
    
    typedef typename Place::template Interface<typename VType::ValueType>::Result ReturnType;
-   typedef typename Place::template Function<Caller<Loki::Typelist<Parall,Alg> >, T> ExecType;
+   // a batch of short transforms is split between the threads instead of every transform
+   typedef typename Parall::template ActualParall<N::value>::Result ActualParall;
+   static const int_t BatchThreads = (ActualParall::NParProc > 1) ? 1 : Parall::NParProc;
+
+   typedef typename Place::template Function<Caller<Loki::Typelist<Parall,Alg> >, T, BatchThreads> Exec1D;
+   typedef typename DimExec<N,VType,Type,Dim,Parall,Place,Variant,Exec1D>::Result ExecType;
    
 public:
    typedef VType ValueType;
    typedef Type TransformType;
+   typedef Dim DimType;
    typedef Parall ParallType;
    typedef Place PlaceType;
+   typedef Variant VariantType;
 
    typedef ExecType Instance;
 
@@ -101,31 +146,13 @@ struct DefineTransform {
    typedef typename TList::Tail::Head VType;
    typedef typename TList::Tail::Tail::Head TransformType;
    typedef typename TList::Tail::Tail::Tail::Tail::Tail::Head Place;
+   typedef typename TList::Tail::Tail::Tail::Tail::Tail::Tail::Head Variant;
 //    typedef typename Place::template Interface<typename VType::ValueType>::Result Abstract;
    
    typedef Transform<typename TList::Head, VType, TransformType,
                 typename TList::Tail::Tail::Tail::Head,
                 typename TList::Tail::Tail::Tail::Tail::Head,
-                Place,ID> Result;
-};
-
-
-
-template<class NList>
-struct TranslateID;
-
-template<id_t N, class T>
-struct TranslateID<Loki::Typelist<s_uint<N>,T> > {
-   static unsigned int apply(const int_t* n) {
-      return TranslateID<T>::apply(n+1)*N + *n;
-   }
-};
-
-template<id_t N>
-struct TranslateID<Loki::Typelist<s_uint<N>,Loki::NullType> > {
-   static unsigned int apply(const int_t* n) {
-      return *n;
-   }
+                Place,ID,Variant> Result;
 };
 
 
@@ -150,13 +177,24 @@ struct TransformFactoryError
 \tparam NList Typelist containing transform lengths
 \tparam T type of data element
 \tparam TransType type of transform: DFT, IDFT, RDFT, IRDFT
-\tparam Dim dimension of transform, defined as SIntID<N>, N=1,2,...
-        By now, only one-dimensional transforms are implemented.
+\tparam Dim dimension of transform, defined as SIntID<N>, N=1,2,3 (see DimensionGroup).
+        The multi-dimensional transforms of the length n in every dimension
+        are complex-valued only. They are computed by the row-column algorithm
+        (see MultiDimPlan) with the data in row-major order.
 \tparam Parall parallelization method
-\tparam Decimation in-time or in-frequency: INTIME, INFREQ
-\tparam FactoryPolicy policy used to create an object factory. Don't define it explicitely, if unsure
+\tparam Place in-place or out-of-place: IN_PLACE, OUT_OF_PLACE
+\tparam Variant plan variants to instantiate (see PlanVariantGroup). The first one is the default.
 
 This generator class makes possible to generate a set of necessary transforms.
+One-dimensional transforms of the lengths, which are not in NList, and
+the complex-valued multi-dimensional ones are planned at runtime by RuntimeFallback.
+CreateTransformObject returns a new object owned by the caller, whereas
+GetTransformObject returns an object shared through the thread-safe PlanCache.
+If several plan variants are instantiated, the planner flag MEASURE
+times them on this machine and takes the fastest one. The choice is
+stored in PlanWisdom and reused by the later calls. The wisdom can be 
+exported into a file and imported by the next process, so that 
+the variants are not measured again.
 The first three template parameters: minimum and maximum power of two and value type
 must be defined. Further parameters have default values and may be omitted.
 Default values for template parameters are taken from the corresponding group-classes
@@ -191,43 +229,187 @@ class T         /* = ValueTypeList*/,        // has to be set explicitely becaus
 class TransType  = TransformTypeGroup::Default,     // DFT, IDFT, RDFT, IRDFT
 class Dim        = SIntID<1>,
 class Parall     = ParallelizationGroup::Default,
-class Place      = PlaceGroup::Default>             // IN_PLACE, OUT_OF_PLACE
+class Place      = PlaceGroup::Default,             // IN_PLACE, OUT_OF_PLACE
+class Variant    = PlanVariantGroup::Default>
 class GenerateTransform {
    //typedef typename GenNumList<Begin,End>::Result NList;
    enum { L1 = Loki::TL::Length<NList>::value };
    enum { L2 = Loki::TL::Length<ValueTypeGroup::FullList>::value };
    enum { L3 = Loki::TL::Length<TransformTypeGroup::FullList>::value };
-   enum { L4 = 1 };
+   enum { L4 = Loki::TL::Length<DimensionGroup::FullList>::value };
    enum { L5 = Loki::TL::Length<ParallelizationGroup::FullList>::value };
    enum { L6 = Loki::TL::Length<PlaceGroup::FullList>::value };
-   typedef TYPELIST_6(s_uint<L1>,s_uint<L2>,s_uint<L3>,s_uint<L4>,s_uint<L5>,s_uint<L6>) LenList;
+   enum { L7 = Loki::TL::Length<PlanVariantGroup::FullList>::value };
+   typedef TYPELIST_7(s_uint<L1>,s_uint<L2>,s_uint<L3>,s_uint<L4>,s_uint<L5>,s_uint<L6>,s_uint<L7>) LenList;
 
    typedef typename Loki::TL::Reverse<LenList>::Result RevLenList;
 
-   typedef TYPELIST_6(Place,Parall,Dim,TransType,T,NList) RevList;
-
-   typedef TranslateID<LenList> Translate;
+   typedef TYPELIST_7(Variant,Place,Parall,Dim,TransType,T,NList) RevList;
 
 public:
    typedef typename ListGenerator<RevList,RevLenList,DefineTransform>::Result Result;
    typedef typename Place::template Interface<typename T::ValueType>::Result ObjectType;
    typedef Place PlaceType;
+   typedef NList LengthList;
+
+   typedef TransformTable<Result, NList, typename AsTypelist<T>::Result, 
+      typename AsTypelist<TransType>::Result, typename AsTypelist<Dim>::Result,
+      typename AsTypelist<Parall>::Result, typename AsTypelist<Place>::Result, 
+      typename AsTypelist<Variant>::Result, ObjectType> Table;
 
-   Loki::Factory<ObjectType,int_t,ObjectType*(*)(),TransformFactoryError> factory;
+private:
+   static const Table& table() 
+   {
+      static const Table t;
+      return t;
+   }
 
-   GenerateTransform() {
-      FactoryInit<Result>::apply(factory);
+   // Times all plan variants and returns the object of the fastest one
+   ObjectType* measure(const PlanKey& k)
+   {
+      // different variants may result in the same code,
+      // so the candidates are made unique before timing
+      std::vector<ObjectType*> cand;
+      std::vector<int_t> cand_id;
+      for (int_t id = 0; id <= Table::MaxVariantID; ++id) {
+	typename Table::CreateFunc create = dispatch.find(k.n, k.vtype_id, k.trans_id, k.dim, 
+	                                                  k.parall_id, k.place_id, dispatch.variant(id));
+	if (!create) continue;
+	ObjectType* obj = create();
+	bool dup = false;
+	for (size_t i=0; i<cand.size() && !dup; ++i)
+	  dup = (typeid(*obj) == typeid(*cand[i]));
+	if (dup) {
+	  delete obj;
+	  continue;
+	}
+	cand.push_back(obj);
+	cand_id.push_back(id);
+      }
+      if (cand.empty())
+	return 0;
+
+      int_t size = 1;
+      for (int_t d=0; d<k.dim; ++d) size *= k.n;
+      // ties are resolved to the lowest variant ID
+      size_t best = 0;
+      double best_time = 0;
+      for (size_t i=0; i<cand.size(); ++i) {
+	const double t = (cand.size() > 1) ? PlanTimer<ObjectType>::apply(cand[i], size) : 0;
+	if (i == 0 || t < best_time) {
+	  best = i;
+	  best_time = t;
+	}
+      }
+      for (size_t i=0; i<cand.size(); ++i)
+	if (i != best) delete cand[i];
+      wisdom.insert(k, cand_id[best]);
+      return cand[best];
+   }
+
+public:
+   const Table& dispatch;
+   PlanCache<ObjectType> cache;
+   PlanWisdom wisdom;
+
+   GenerateTransform() : dispatch(table()) { }
+
+   /// Maps the wisdom file with the plan variants measured before
+   /** The file is written by wisdom.export_to(). If it can not be read,
+       the default variants are used.
+   */
+   explicit GenerateTransform(const char* wisdom_file) : dispatch(table()) 
+   {
+      wisdom.import_from(wisdom_file);
    }
 
+   /// Creates a new transform object, which is owned by the caller
+   /** \param planner ESTIMATE takes the plan variant from wisdom or the default one,
+       MEASURE times the plan variants, which were not measured yet
+   */
    ObjectType* CreateTransformObject(int_t n, int_t vtype_id, 
                                    int_t trans_id = TransformTypeGroup::Default::ID, 
                                    int_t dim = 1, 
                                    int_t parall_id = ParallelizationGroup::Default::ID, 
-                                   int_t place_id = PlaceGroup::Default::ID) 
+                                   int_t place_id = PlaceGroup::Default::ID,
+                                   PlannerFlag planner = ESTIMATE) 
    {
-      int_t narr[] = {n-1, vtype_id, trans_id, dim-1, parall_id, place_id};
-      int_t obj_id = Translate::apply(narr);
-      return factory.CreateObject(obj_id);
+      const PlanKey key(n, vtype_id, trans_id, dim, parall_id, place_id);
+      int_t var = 0;
+      if (Table::NumVariants > 1) {
+	const int_t id = wisdom.find(key);
+	if (id >= 0 && dispatch.variant(id) >= 0) 
+	  var = dispatch.variant(id);
+	else if (planner == MEASURE) {
+	  ObjectType* obj = measure(key);
+	  if (obj) return obj;
+	}
+      }
+
+      typename Table::CreateFunc create = dispatch.find(n, vtype_id, trans_id, dim, parall_id, place_id, var);
+      if (create) 
+        return create();
+
+      // the length is not compiled in, plan it at runtime
+      ObjectType* obj = RuntimeFallback<T,Place>::Create(n, vtype_id, trans_id, dim, parall_id, place_id);
+      if (!obj) 
+        return TransformFactoryError<int_t,ObjectType>::OnUnknownType(n);
+      return obj;
+   }
+
+   /// Returns the shared transform object from the cache
+   /** The object is created by CreateTransformObject on the first request
+       and owned by this class, so it must not be deleted by the caller.
+       The function may be called from several threads concurrently.
+   */
+   ObjectType* GetTransformObject(int_t n, int_t vtype_id, 
+                                  int_t trans_id = TransformTypeGroup::Default::ID, 
+                                  int_t dim = 1, 
+                                  int_t parall_id = ParallelizationGroup::Default::ID, 
+                                  int_t place_id = PlaceGroup::Default::ID,
+                                  PlannerFlag planner = ESTIMATE) 
+   {
+      const PlanKey key(n, vtype_id, trans_id, dim, parall_id, place_id);
+      ObjectType* obj = cache.find(key);
+      if (!obj)
+	obj = cache.insert(key, CreateTransformObject(n, vtype_id, trans_id, dim, parall_id, place_id, planner));
+      return obj;
+   }
+
+   /// Creates a new transform object of strided data, which is owned by the caller
+   /** \param istride, ostride distances between the elements of the transform
+       \param loops batch loops from the outermost to the innermost one
+       All distances are counted in complex elements. 
+       The compiled transform of the length n is used for unit strides,
+       if it is out-of-place, and the single-threaded one, if there are batch loops.
+   */
+   AbstractFFT_guru<typename T::ValueType>* 
+   CreateGuruObject(int_t n, int_t vtype_id, int_t trans_id, 
+                    int_t istride, int_t ostride, 
+                    const std::vector<IODim>& loops = std::vector<IODim>(),
+                    int_t parall_id = ParallelizationGroup::Default::ID) 
+   {
+      typedef typename T::ValueType VT;
+      if (n < 1 || vtype_id != T::ID) 
+        return TransformFactoryError<int_t,AbstractFFT_guru<VT> >::OnUnknownType(n);
+
+      AbstractFFT_oop<VT>* obj = 0;
+      if (istride == 1 && ostride == 1 && Place::ID == OUT_OF_PLACE::ID) {
+	// the batch loop is shared by the threads, which call the single-threaded transform,
+	// since the parallelized one expects the whole team of its threads
+	const int_t obj_parall_id = loops.empty() ? parall_id : 0;
+	typename Table::CreateFunc create = dispatch.find(n, vtype_id, trans_id, 1, obj_parall_id, Place::ID);
+	if (create)
+	  obj = dynamic_cast<AbstractFFT_oop<VT>*>(create());
+      }
+
+      const int nthreads = static_cast<int>(parall_id) + 1;
+      if (trans_id == DFT::ID)
+	return new GuruTransform<T,DFT>(n, istride, ostride, loops, nthreads, obj);
+      if (trans_id == IDFT::ID)
+	return new GuruTransform<T,IDFT>(n, istride, ostride, loops, nthreads, obj);
+      delete obj;
+      return TransformFactoryError<int_t,AbstractFFT_guru<VT> >::OnUnknownType(n);
    }
 
 };
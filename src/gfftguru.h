@@ -0,0 +1,161 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gfftguru_h
+#define __gfftguru_h
+
+/** \file
+    \brief Transforms of strided data with arbitrary batch loops
+
+    The data layout is described as in the guru interface of FFTW:
+    the transform length with the input and output strides and
+    any number of batch loops, each with its own input and output distance.
+    All strides and distances are counted in complex elements.
+*/
+
+#include "gfftruntime.h"
+
+#include <vector>
+
+namespace GFFT {
+
+/// One dimension of a strided layout
+/** \a n is the number of elements (or transforms in a batch loop),
+    \a is and \a os are the distances between them in the input and
+    the output in complex elements.
+*/
+struct IODim
+{
+   int_t n, is, os;
+
+   IODim() : n(1), is(0), os(0) { }
+   IODim(const int_t n_, const int_t is_, const int_t os_) : n(n_), is(is_), os(os_) { }
+};
+
+/// Abstract interface of the transforms of strided data
+template<typename T>
+class AbstractFFT_guru {
+public:
+   /// Transforms all the batches from src into dst
+   /** src and dst may be the same array, if the input and output layouts
+       are equal.
+   */
+   virtual void fft(const T* src, T* dst) = 0;
+
+   virtual ~AbstractFFT_guru() {}
+};
+
+
+/// %Transform of strided data with batch loops
+/*!
+\tparam VType value type
+\tparam Type type of transform: DFT, IDFT
+
+The strides of the transform are folded into the addressing of
+the first and the following stages of RuntimeInTimeOOP, so that the
+strided input is neither gathered nor the output scattered.
+If both strides are 1 and the length is compiled in GenerateTransform,
+the compiled transform object is called for every batch instead.
+The outermost batch loop is distributed between the threads.
+\sa GenerateTransform::CreateGuruObject
+*/
+template<class VType, class Type>
+class GuruTransform : public AbstractFFT_guru<typename VType::ValueType>
+{
+   typedef typename VType::ValueType T;
+   typedef typename InterleavedType<VType>::Result IVType;
+   typedef typename IVType::ValueType BT;
+
+   RuntimeInTimeOOP<IVType,Type::Sign> m_plan;
+   AbstractFFT_oop<T>* m_obj;
+   const int_t m_n, m_is, m_os;
+   const std::vector<IODim> m_loops;
+   const int m_nthreads;
+   ScratchPool<BT> m_buf;   // the gathered input of an in-place batch
+
+   // transforms a single batch
+   void single(const BT* src, BT* dst)
+   {
+      if (src == dst) {
+	ScratchBuffer<BT> buf(m_buf);
+	BT* tmp = buf.get();
+	for (int_t i=0; i<m_n; ++i) {
+	  tmp[2*i]   = src[2*i*m_is];
+	  tmp[2*i+1] = src[2*i*m_is+1];
+	}
+	transform(tmp, 1, dst);
+      }
+      else
+	transform(src, m_is, dst);
+   }
+
+   void transform(const BT* src, const int_t is, BT* dst)
+   {
+      if (m_obj && is == 1 && m_os == 1) {
+	m_obj->fft(reinterpret_cast<const T*>(src), reinterpret_cast<T*>(dst));
+	return;
+      }
+      m_plan.apply(src, dst, is, m_os);
+      if (Type::Sign == -1) {
+	const int_t os2 = 2*m_os;
+	for (BT* i=dst; i<dst+m_n*os2; i+=os2) { i[0]/=m_n; i[1]/=m_n; }
+      }
+   }
+
+   void loop(const uint_t level, const BT* src, BT* dst)
+   {
+      if (level == m_loops.size()) {
+	single(src, dst);
+	return;
+      }
+      const IODim& d = m_loops[level];
+      for (int_t i=0; i<d.n; ++i)
+	loop(level+1, src + 2*i*d.is, dst + 2*i*d.os);
+   }
+
+   // disable copying, since the compiled object is owned
+   GuruTransform(const GuruTransform&);
+   GuruTransform& operator=(const GuruTransform&);
+
+public:
+   /// Plans the transform of the length n
+   /** \param obj compiled transform object of the length n or null, it is owned afterwards
+       \param nthreads number of threads to share the batch loop or, if there
+                       is no batch loop, to compute the transform
+   */
+   GuruTransform(const int_t n, const int_t istride, const int_t ostride,
+                 const std::vector<IODim>& loops, const int nthreads, AbstractFFT_oop<T>* obj = 0)
+   : m_plan(n, loops.empty() ? nthreads : 1), m_obj(obj),
+     m_n(n), m_is(istride), m_os(ostride), m_loops(loops), m_nthreads(nthreads), m_buf(2*n) { }
+
+   ~GuruTransform() { delete m_obj; }
+
+   void fft(const T* src, T* dst)
+   {
+      const BT* s = reinterpret_cast<const BT*>(src);
+      BT* d = reinterpret_cast<BT*>(dst);
+      if (m_loops.empty()) {
+	single(s, d);
+	return;
+      }
+      const IODim& d0 = m_loops[0];
+      #pragma omp parallel for schedule(static) num_threads(m_nthreads) if(m_nthreads > 1 && d0.n > 1)
+      for (int_t i=0; i<d0.n; ++i)
+	loop(1, s + 2*i*d0.is, d + 2*i*d0.os);
+   }
+};
+
+}  //namespace GFFT
+
+#endif /*__gfftguru_h*/
@@ -0,0 +1,122 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gfftisa_h
+#define __gfftisa_h
+
+/** \file
+    \brief Runtime choice of the instruction set level of the transforms
+
+    The transform tree is instantiated once per ISALevel with the value type
+    ISAType<VType,ISA>. The vectorized kernels of every level carry
+    the target attributes, so all the levels are compiled with the same flags
+    and can be placed into separate translation units by the explicit
+    instantiation of ISATransformSet (see gfftlib.h).
+    GenerateTransformISA takes the level supported by the processor (cpu_isa).
+*/
+
+#include "gfftgen.h"
+#include "gfftcpu.h"
+
+namespace GFFT {
+
+/// Transform set of one instruction set level
+/*!
+\tparam ISA instruction set level (ISALevel)
+
+The parameters NList,...,Place are the ones of GenerateTransform.
+The transforms are created by the GenerateTransform of ISAType<VType,ISA>,
+which is constructed on the first call of Create. The function Create is
+not inline, so that it is compiled only in the translation unit, where
+ISATransformSet is instantiated explicitly, if it is declared extern elsewhere.
+*/
+template<int ISA, class NList, class VType, class TransType, class Dim, class Parall, class Place>
+struct ISATransformSet
+{
+   typedef GenerateTransform<NList, ISAType<VType,ISA>, TransType, Dim, Parall, Place> Result;
+   typedef typename Place::template Interface<typename VType::ValueType>::Result ObjectType;
+
+   static ObjectType* Create(int_t n, int_t vtype_id, int_t trans_id, int_t dim,
+                             int_t parall_id, int_t place_id, PlannerFlag planner);
+};
+
+template<int ISA, class NList, class VType, class TransType, class Dim, class Parall, class Place>
+typename ISATransformSet<ISA,NList,VType,TransType,Dim,Parall,Place>::ObjectType*
+ISATransformSet<ISA,NList,VType,TransType,Dim,Parall,Place>::Create(int_t n, int_t vtype_id,
+   int_t trans_id, int_t dim, int_t parall_id, int_t place_id, PlannerFlag planner)
+{
+   static Result gen;
+   return gen.CreateTransformObject(n, vtype_id, trans_id, dim, parall_id, place_id, planner);
+}
+
+
+/// Set of transforms for every instruction set level with the choice at runtime
+/*!
+The template parameters are the ones of GenerateTransform, VType must be a single value type.
+The level is determined by cpu_isa() in the constructor or given explicitly,
+then every transform object is created from the ISATransformSet of this level.
+The objects of all levels have the same interface ObjectType.
+
+Usage:
+\code
+GFFT::GenerateTransformISA<NList, GFFT::DOUBLE, GFFT::DFT> gfft;
+GFFT::AbstractFFT_oop<double>* fft = gfft.CreateTransformObject(1024, GFFT::DOUBLE::ID);
+\endcode
+*/
+template<class NList,
+class VType,
+class TransType  = TransformTypeGroup::Default,
+class Dim        = SIntID<1>,
+class Parall     = ParallelizationGroup::Default,
+class Place      = PlaceGroup::Default>
+class GenerateTransformISA
+{
+   int m_isa;
+
+public:
+   typedef typename Place::template Interface<typename VType::ValueType>::Result ObjectType;
+   typedef Place PlaceType;
+   typedef NList LengthList;
+
+   /// Uses the level isa, by default the highest one supported by the processor
+   explicit GenerateTransformISA(const int isa = cpu_isa())
+   : m_isa(isa < ISA_GENERIC ? ISA_GENERIC : (isa > ISA_AVX512 ? ISA_AVX512 : isa)) { }
+
+   /// Instruction set level of the created transforms
+   int isa() const { return m_isa; }
+
+   /// Creates a new transform object, which is owned by the caller
+   ObjectType* CreateTransformObject(int_t n, int_t vtype_id,
+                                   int_t trans_id = TransformTypeGroup::Default::ID,
+                                   int_t dim = 1,
+                                   int_t parall_id = ParallelizationGroup::Default::ID,
+                                   int_t place_id = PlaceGroup::Default::ID,
+                                   PlannerFlag planner = ESTIMATE) const
+   {
+      switch (m_isa) {
+	case ISA_AVX512:
+	  return ISATransformSet<ISA_AVX512,NList,VType,TransType,Dim,Parall,Place>::Create(n, vtype_id, trans_id, dim, parall_id, place_id, planner);
+	case ISA_AVX2:
+	  return ISATransformSet<ISA_AVX2,NList,VType,TransType,Dim,Parall,Place>::Create(n, vtype_id, trans_id, dim, parall_id, place_id, planner);
+	case ISA_SSE2:
+	  return ISATransformSet<ISA_SSE2,NList,VType,TransType,Dim,Parall,Place>::Create(n, vtype_id, trans_id, dim, parall_id, place_id, planner);
+	default:
+	  return ISATransformSet<ISA_GENERIC,NList,VType,TransType,Dim,Parall,Place>::Create(n, vtype_id, trans_id, dim, parall_id, place_id, planner);
+      }
+   }
+};
+
+}  //namespace GFFT
+
+#endif /*__gfftisa_h*/
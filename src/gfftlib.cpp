@@ -0,0 +1,35 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+/** \file
+    \brief Explicit instantiation of the transform catalogue of the library libgfft
+
+    The catalogue is defined in gfftlib.h and configured by the variables
+    GFFT_LIB_PMIN, GFFT_LIB_PMAX, GFFT_LIB_NUMTHREADS and GFFT_LIB_FLOAT
+    in CMakeLists.txt file in the same folder.
+*/
+
+#define GFFT_LIB_BUILD
+
+#include "gfftlib.h"
+
+namespace GFFT {
+
+GFFT_LIB_INSTANTIATE_ALL()
+
+#if GFFT_LIB_FLOAT == 1
+GFFT_LIB_INSTANTIATE_FLOAT()
+#endif
+
+}  //namespace GFFT
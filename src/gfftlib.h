@@ -0,0 +1,161 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gfftlib_h
+#define __gfftlib_h
+
+/** \file
+    \brief Catalogue of transforms precompiled into the library libgfft
+
+    The transforms of the catalogue are instantiated once in gfftlib.cpp.
+    A translation unit, which includes this header and uses LibTransformSet,
+    does not instantiate them again because of the explicit instantiation
+    declarations below, so it compiles fast and needs no -ftemplate-depth.
+    The program must be linked with libgfft.
+
+    The catalogue is configured by the following macros, which must be defined
+    equally for the library and its users (CMake variables of the same names):
+    - GFFT_LIB_PMIN, GFFT_LIB_PMAX: the lengths are 2^GFFT_LIB_PMIN,...,2^GFFT_LIB_PMAX
+    - GFFT_LIB_NUMTHREADS: number of %OpenMP threads, 1 means serial transforms
+    - GFFT_LIB_FLOAT: 1 adds single precision transforms to the catalogue
+
+    The lengths outside the catalogue are planned at runtime by RuntimeFallback.
+
+    LibTransformSetISA is the same catalogue for every instruction set level
+    with the choice at runtime (see gfftisa.h). The levels are instantiated in
+    gfftlib_sse2.cpp, gfftlib_avx2.cpp and gfftlib_avx512.cpp.
+*/
+
+#include "gfft.h"
+
+#ifndef GFFT_LIB_PMIN
+#define GFFT_LIB_PMIN 2
+#endif
+
+#ifndef GFFT_LIB_PMAX
+#define GFFT_LIB_PMAX 10
+#endif
+
+#ifndef GFFT_LIB_NUMTHREADS
+#define GFFT_LIB_NUMTHREADS 1
+#endif
+
+#ifndef GFFT_LIB_FLOAT
+#define GFFT_LIB_FLOAT 0
+#endif
+
+namespace GFFT {
+
+/// Transform set of the library libgfft
+/*!
+\tparam VType value type: DOUBLE, COMPLEX_DOUBLE, or FLOAT, COMPLEX_FLOAT if GFFT_LIB_FLOAT is 1
+\tparam Place IN_PLACE or OUT_OF_PLACE
+
+Usage:
+\code
+GFFT::LibTransformSet<GFFT::DOUBLE,GFFT::OUT_OF_PLACE>::Result gfft;
+GFFT::AbstractFFT_oop<double>* fft = gfft.CreateTransformObject(1024, GFFT::DOUBLE::ID, GFFT::DFT::ID, 1, 0);
+\endcode
+*/
+template<class VType, class Place>
+struct LibTransformSet
+{
+   typedef typename GenPowerList<GFFT_LIB_PMIN,GFFT_LIB_PMAX,2>::Result NList;
+   typedef TYPELIST_2(DFT,IDFT) TransList;
+   typedef OpenMP<GFFT_LIB_NUMTHREADS> Parall;
+
+   typedef GenerateTransform<NList, VType, TransList, SIntID<1>, Parall, Place> Result;
+   typedef typename Result::Result List;
+   typedef typename Result::ObjectType ObjectType;
+};
+
+/// Transform set of the library libgfft with the instruction set level chosen at runtime
+/*!
+Usage:
+\code
+GFFT::LibTransformSetISA<GFFT::DOUBLE,GFFT::OUT_OF_PLACE>::Result gfft;   // uses cpu_isa()
+GFFT::AbstractFFT_oop<double>* fft = gfft.CreateTransformObject(1024, GFFT::DOUBLE::ID, GFFT::DFT::ID, 1, 0);
+\endcode
+*/
+template<class VType, class Place>
+struct LibTransformSetISA
+{
+   typedef LibTransformSet<VType,Place> Set;
+   typedef GenerateTransformISA<typename Set::NList, VType, typename Set::TransList, 
+                                SIntID<1>, typename Set::Parall, Place> Result;
+   typedef typename Result::ObjectType ObjectType;
+};
+
+}  //namespace GFFT
+
+/// Explicit instantiation definition (EXTERN is empty) or declaration (EXTERN is extern)
+/// of the transforms from the catalogue for the value type VT and place PL
+#define GFFT_LIB_INSTANTIATE(EXTERN, VT, PL) \
+EXTERN template class GenerateTransform<LibTransformSet<VT,PL>::NList, VT, \
+   LibTransformSet<VT,PL>::TransList, SIntID<1>, LibTransformSet<VT,PL>::Parall, PL>; \
+EXTERN template class TransformTable<LibTransformSet<VT,PL>::List, LibTransformSet<VT,PL>::NList, \
+   AsTypelist<VT>::Result, LibTransformSet<VT,PL>::TransList, AsTypelist<SIntID<1> >::Result, \
+   AsTypelist<LibTransformSet<VT,PL>::Parall>::Result, AsTypelist<PL>::Result, \
+   AsTypelist<DefaultPlan>::Result, LibTransformSet<VT,PL>::ObjectType>;
+
+#define GFFT_LIB_INSTANTIATE_ALL(EXTERN) \
+GFFT_LIB_INSTANTIATE(EXTERN, DOUBLE, IN_PLACE) \
+GFFT_LIB_INSTANTIATE(EXTERN, DOUBLE, OUT_OF_PLACE) \
+GFFT_LIB_INSTANTIATE(EXTERN, COMPLEX_DOUBLE, IN_PLACE) \
+GFFT_LIB_INSTANTIATE(EXTERN, COMPLEX_DOUBLE, OUT_OF_PLACE)
+
+#define GFFT_LIB_INSTANTIATE_FLOAT(EXTERN) \
+GFFT_LIB_INSTANTIATE(EXTERN, FLOAT, IN_PLACE) \
+GFFT_LIB_INSTANTIATE(EXTERN, FLOAT, OUT_OF_PLACE) \
+GFFT_LIB_INSTANTIATE(EXTERN, COMPLEX_FLOAT, IN_PLACE) \
+GFFT_LIB_INSTANTIATE(EXTERN, COMPLEX_FLOAT, OUT_OF_PLACE)
+
+/// Explicit instantiation definition or declaration of the catalogue
+/// for the instruction set level ISA, the value type VT and place PL
+#define GFFT_LIB_INSTANTIATE_ISA(EXTERN, ISA, VT, PL) \
+EXTERN template struct ISATransformSet<ISA, LibTransformSet<VT,PL>::NList, VT, \
+   LibTransformSet<VT,PL>::TransList, SIntID<1>, LibTransformSet<VT,PL>::Parall, PL>;
+
+#if GFFT_LIB_FLOAT == 1
+#define GFFT_LIB_INSTANTIATE_ISA_FLOAT(EXTERN, ISA) \
+GFFT_LIB_INSTANTIATE_ISA(EXTERN, ISA, FLOAT, IN_PLACE) \
+GFFT_LIB_INSTANTIATE_ISA(EXTERN, ISA, FLOAT, OUT_OF_PLACE) \
+GFFT_LIB_INSTANTIATE_ISA(EXTERN, ISA, COMPLEX_FLOAT, IN_PLACE) \
+GFFT_LIB_INSTANTIATE_ISA(EXTERN, ISA, COMPLEX_FLOAT, OUT_OF_PLACE)
+#else
+#define GFFT_LIB_INSTANTIATE_ISA_FLOAT(EXTERN, ISA)
+#endif
+
+#define GFFT_LIB_INSTANTIATE_ISA_ALL(EXTERN, ISA) \
+GFFT_LIB_INSTANTIATE_ISA(EXTERN, ISA, DOUBLE, IN_PLACE) \
+GFFT_LIB_INSTANTIATE_ISA(EXTERN, ISA, DOUBLE, OUT_OF_PLACE) \
+GFFT_LIB_INSTANTIATE_ISA(EXTERN, ISA, COMPLEX_DOUBLE, IN_PLACE) \
+GFFT_LIB_INSTANTIATE_ISA(EXTERN, ISA, COMPLEX_DOUBLE, OUT_OF_PLACE) \
+GFFT_LIB_INSTANTIATE_ISA_FLOAT(EXTERN, ISA)
+
+// The users of the library don't instantiate the catalogue
+#ifndef GFFT_LIB_BUILD
+namespace GFFT {
+GFFT_LIB_INSTANTIATE_ALL(extern)
+#if GFFT_LIB_FLOAT == 1
+GFFT_LIB_INSTANTIATE_FLOAT(extern)
+#endif
+GFFT_LIB_INSTANTIATE_ISA_ALL(extern, ISA_GENERIC)
+GFFT_LIB_INSTANTIATE_ISA_ALL(extern, ISA_SSE2)
+GFFT_LIB_INSTANTIATE_ISA_ALL(extern, ISA_AVX2)
+GFFT_LIB_INSTANTIATE_ISA_ALL(extern, ISA_AVX512)
+}  //namespace GFFT
+#endif
+
+#endif /*__gfftlib_h*/
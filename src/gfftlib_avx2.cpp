@@ -1,5 +1,5 @@
 /***************************************************************************
- *   Copyright (C) 2007-2015 by Vladimir Mirnyy                            *
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
  *                                                                         *
  *   This program is free software; you can redistribute it and/or modify  *
  *   it under the terms of the GNU General Public License as published by  *
@@ -12,37 +12,19 @@
  *   GNU General Public License for more details.                          *
  ***************************************************************************/
 
-#ifndef __finit_h
-#define __finit_h
-
 /** \file
-    \brief Initialization of object factory
-*/
-
-#include "Typelist.h"
+    \brief Catalogue of libgfft for the instruction set level ISA_AVX2
 
-template<class TList>
-struct FactoryInit;
-
-/// Object factory initialization class
-/** Register all classes from TypeList in
-    object factory Fact
+    The vectorized kernels are compiled with their target attributes,
+    so this file needs the same compiler flags as gfftlib.cpp.
 */
 
-template<class H, class T>
-struct FactoryInit<Loki::Typelist<H,T> > {
-   template<class Fact>
-   static void apply(Fact& f) {
-      f.Register(H::ID,H::Create);
-      FactoryInit<T>::apply(f);
-   }
-};
+#define GFFT_LIB_BUILD
+
+#include "gfftlib.h"
 
-template<>
-struct FactoryInit<Loki::NullType> {
-   template<class Fact>
-   static void apply(Fact&) { }
-};
+namespace GFFT {
 
+GFFT_LIB_INSTANTIATE_ISA_ALL(, ISA_AVX2)
 
-#endif /*__finit_h*/
+}  //namespace GFFT
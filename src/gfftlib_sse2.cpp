@@ -0,0 +1,31 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+/** \file
+    \brief Catalogue of libgfft for the instruction set levels ISA_GENERIC and ISA_SSE2
+
+    The vectorized kernels are compiled with their target attributes,
+    so this file needs the same compiler flags as gfftlib.cpp.
+*/
+
+#define GFFT_LIB_BUILD
+
+#include "gfftlib.h"
+
+namespace GFFT {
+
+GFFT_LIB_INSTANTIATE_ISA_ALL(, ISA_GENERIC)
+GFFT_LIB_INSTANTIATE_ISA_ALL(, ISA_SSE2)
+
+}  //namespace GFFT
@@ -0,0 +1,218 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gfftmultidim_h
+#define __gfftmultidim_h
+
+/** \file
+    \brief Multi-dimensional complex-valued transforms
+
+    The transform of the length n in every of dim dimensions
+    is computed by the row-column decomposition from a one-dimensional
+    out-of-place transform of the length n.
+*/
+
+#include "gfftpolicy.h"
+#include "gfftalg.h"
+#include "gffttranspose.h"
+#include "gfftcache.h"
+
+#include <algorithm>
+
+namespace GFFT {
+
+/// Number of columns, which are gathered and transformed together
+/** The columns of a block are read and written row by row in
+    contiguous pieces, so that every loaded cache line is used.
+*/
+static const int_t MultiDimBlock = 8;
+
+/// Row-column algorithm of a multi-dimensional transform
+/*!
+\tparam VType value type
+\tparam Line one-dimensional out-of-place transform of the length n
+        with the member function fft(const T*, T*)
+
+The data are stored in row-major order. The rows (the last dimension)
+are transformed directly from the source into the destination.
+Then every other dimension is transformed in-place by blocks of MultiDimBlock
+columns, which are transposed into a contiguous buffer and back by Transpose.
+The rows and the column blocks of all the planes are distributed between
+nthreads threads, so Line must not be parallelized itself.
+*/
+template<class VType, class Line>
+class MultiDimPlan
+{
+   typedef typename VType::ValueType T;
+   typedef typename InterleavedType<VType>::Result IVType;
+   typedef typename IVType::ValueType BT;
+   // the blocks of columns are transposed by a single thread
+   typedef Transpose<IVType,Serial> Trans;
+
+   Line* m_line;
+   const int_t m_n, m_size;
+   const int m_nthreads;
+   ScratchPool<BT> m_row;      // a row of the in-place transform for every thread
+   ScratchPool<BT> m_blocks;   // two blocks of columns for every thread
+
+   void line(const BT* src, BT* dst)
+   {
+      m_line->fft(reinterpret_cast<const T*>(src), reinterpret_cast<T*>(dst));
+   }
+
+   void rows(const BT* src, BT* dst)
+   {
+      const int_t n2 = 2*m_n;
+      const int_t nrows = m_size/m_n;
+      #pragma omp parallel num_threads(m_nthreads) if(m_nthreads > 1 && nrows > 1)
+      {
+	if (src == dst) {
+	  ScratchBuffer<BT> buf(m_row);
+	  BT* tmp = buf.get();
+	  #pragma omp for schedule(static)
+	  for (int_t r=0; r<nrows; ++r) {
+	    line(src + r*n2, tmp);
+	    std::copy(tmp, tmp + n2, dst + r*n2);
+	  }
+	}
+	else {
+	  #pragma omp for schedule(static)
+	  for (int_t r=0; r<nrows; ++r)
+	    line(src + r*n2, dst + r*n2);
+	}
+      }
+   }
+
+   // transforms the dimension, whose elements are s complex numbers apart
+   void columns(BT* data, const int_t s)
+   {
+      const int_t n2 = 2*m_n;
+      const int_t nouter = m_size/(m_n*s);
+      const int_t nblocks = (s + MultiDimBlock - 1)/MultiDimBlock;
+      #pragma omp parallel num_threads(m_nthreads) if(m_nthreads > 1 && nouter*nblocks > 1)
+      {
+	ScratchBuffer<BT> buf(m_blocks);
+	BT* a = buf.get();
+	BT* b = a + n2*MultiDimBlock;
+	#pragma omp for schedule(static)
+	for (int_t ob=0; ob<nouter*nblocks; ++ob) {
+	  const int_t o = ob/nblocks;
+	  const int_t cb = (ob%nblocks)*MultiDimBlock;
+	  const int_t nc = std::min(MultiDimBlock, s - cb);
+	  BT* d = data + 2*(o*m_n*s + cb);
+	  Trans::apply(d, a, m_n, nc, s, m_n);
+	  for (int_t c=0; c<nc; ++c)
+	    line(a + c*n2, b + c*n2);
+	  Trans::apply(b, d, nc, m_n, m_n, s);
+	}
+      }
+   }
+
+   static int_t power(const int_t n, const int_t dim)
+   {
+      int_t p = 1;
+      for (int_t i=0; i<dim; ++i) p *= n;
+      return p;
+   }
+
+   // disable copying, since the line transform is owned
+   MultiDimPlan(const MultiDimPlan&);
+   MultiDimPlan& operator=(const MultiDimPlan&);
+
+public:
+   /// \param line one-dimensional transform of the length n, it is owned afterwards
+   MultiDimPlan(const int_t n, const int_t dim, const int nthreads, Line* line)
+   : m_line(line), m_n(n), m_size(power(n, dim)), m_nthreads(nthreads),
+     m_row(2*n), m_blocks(4*n*MultiDimBlock) { }
+
+   ~MultiDimPlan() { delete m_line; }
+
+   /// Total number of complex elements
+   int_t size() const { return m_size; }
+
+   void apply(const BT* src, BT* dst)
+   {
+      rows(src, dst);
+      for (int_t s=m_n; s<m_size; s*=m_n)
+	columns(dst, s);
+   }
+};
+
+
+/// Multi-dimensional transform implementing the interface of Place
+/*!
+\tparam VType value type
+\tparam Place IN_PLACE, OUT_OF_PLACE
+\tparam Line one-dimensional out-of-place transform (see MultiDimPlan)
+\sa MultiDimPlan, GenerateTransform
+*/
+template<class VType, class Place, class Line>
+class MultiDimTransform;
+
+template<class VType, class Line>
+class MultiDimTransform<VType,OUT_OF_PLACE,Line>
+: public OUT_OF_PLACE::Interface<typename VType::ValueType>::Result
+{
+   typedef typename VType::ValueType T;
+   typedef typename InterleavedType<VType>::Result::ValueType BT;
+
+   MultiDimPlan<VType,Line> m_plan;
+
+public:
+   MultiDimTransform(const int_t n, const int_t dim, const int nthreads, Line* line)
+   : m_plan(n, dim, nthreads, line) { }
+
+   void fft(const T* src, T* dst)
+   {
+      m_plan.apply(reinterpret_cast<const BT*>(src), reinterpret_cast<BT*>(dst));
+   }
+};
+
+template<class VType, class Line>
+class MultiDimTransform<VType,IN_PLACE,Line>
+: public IN_PLACE::Interface<typename VType::ValueType>::Result
+{
+   typedef typename VType::ValueType T;
+   typedef typename InterleavedType<VType>::Result::ValueType BT;
+
+   MultiDimPlan<VType,Line> m_plan;
+
+public:
+   MultiDimTransform(const int_t n, const int_t dim, const int nthreads, Line* line)
+   : m_plan(n, dim, nthreads, line) { }
+
+   void fft(T* data)
+   {
+      BT* d = reinterpret_cast<BT*>(data);
+      m_plan.apply(d, d);
+   }
+};
+
+/// Multi-dimensional transform of compile-time parameters
+/*!
+\tparam N length in every dimension
+\tparam Dim number of dimensions
+\tparam NThreads number of threads
+
+The default constructor makes it usable as Transform::Instance.
+*/
+template<int_t N, int_t Dim, int NThreads, class VType, class Place, class Line>
+struct MultiDimFunction : public MultiDimTransform<VType,Place,Line>
+{
+   MultiDimFunction() : MultiDimTransform<VType,Place,Line>(N, Dim, NThreads, new Line()) { }
+};
+
+}  //namespace GFFT
+
+#endif /*__gfftmultidim_h*/
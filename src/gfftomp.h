@@ -85,6 +85,17 @@ int_t SimpleSpec = (M / Step),
 bool isStd = Loki::TypeTraits<typename VType::ValueType>::isStdFundamental>
 class DFTk_x_Im_T_omp;
 
+/// Radix of DFTk_x_Im_T_omp, which is computed by DFTk_x_Im_T_simd
+/** DFTk_inp_adapter reads the rows in the order of Permutation<K,KFact>.
+    It is the order of SIMDButterfly (KernelInputOrder) for the powers of two
+    up to 16 and for the primes, which are not computed by Rader's algorithm.
+*/
+template<int_t K, typename KFact>
+struct SIMDRadixOMP {
+   static const bool value = (((K & (K-1)) == 0) && (K <= 16))
+      || ((Loki::TL::Length<KFact>::value == 1) && (KFact::Head::second::value == 1) && !RaderRadix<K>::value);
+};
+
 
 /** \class {GFFT::InTime_omp}
 \brief %OpenMP parallelized Danielson-Lanczos section of the decimation-in-time FFT version.
@@ -143,6 +154,15 @@ template<int_t N, typename Head, typename Tail, typename VType, int S, class W1,
 class InTime_omp<1,N,Loki::Typelist<Head,Tail>,VType,S,W1,LastK> 
 : public InTime<N,Loki::Typelist<Head,Tail>,VType,S,W1,LastK> {};
 
+// Prime N is not split between threads
+template<int_t NThreads, int_t N, typename VType, int S, class W1, int_t LastK>
+class InTime_omp<NThreads,N,Loki::Typelist<Pair<SInt<N>, SInt<1> >, Loki::NullType>,VType,S,W1,LastK> 
+: public InTime<N,Loki::Typelist<Pair<SInt<N>, SInt<1> >, Loki::NullType>,VType,S,W1,LastK> {};
+
+template<int_t N, typename VType, int S, class W1, int_t LastK>
+class InTime_omp<1,N,Loki::Typelist<Pair<SInt<N>, SInt<1> >, Loki::NullType>,VType,S,W1,LastK> 
+: public InTime<N,Loki::Typelist<Pair<SInt<N>, SInt<1> >, Loki::NullType>,VType,S,W1,LastK> {};
+
 ///////////////////////
 
 // Assume: K >= NThreadsCreate
@@ -189,38 +209,6 @@ struct ParallLoopOOP<Perm,N2,M2,LastK2,NThreads,K,I,false>
 };
 
 
-template<int_t K, typename KFact>
-struct Permutation;
-  
-template<int_t K, int_t N, int_t P, typename Tail>
-struct Permutation<K, Loki::Typelist<Pair<SInt<N>,SInt<P> >,Tail> >
-{
-  static const int_t M = K/N;   // K = M*N
-  typedef Permutation<K/N, Loki::Typelist<Pair<SInt<N>,SInt<P-1> >,Tail> > Next;
-  static int_t value(const int_t ii)
-  {
-    assert(ii >= 0 && ii < K);
-    return (ii%N)*M + Next::value(ii/N);
-  }
-};
-
-template<int_t K, int_t N, typename Tail>
-struct Permutation<K, Loki::Typelist<Pair<SInt<N>,SInt<0> >,Tail> >
-: public Permutation<K, Tail> {};
-
-// template<>
-// struct Permutation<4, Loki::Typelist<Pair<SInt<2>,SInt<2> >,Loki::NullType> >
-// {
-//   static int_t value(const int_t ii) { return ii; }
-// };
-
-template<int_t K>
-struct Permutation<K, Loki::NullType>
-{
-  static int_t value(const int_t ii) { return ii; }
-};
-
-
 template<int_t K, typename KFact, int_t M, typename VType, int S, typename W1,
 bool isStd = Loki::TypeTraits<typename VType::ValueType>::isStdFundamental>
 struct DFTk_inp_adapter;
@@ -290,7 +278,8 @@ struct DFTk_inp_adapter<K, Loki::Typelist<Pair<SInt<KF>, SInt<0> >, Tail>, M, VT
 // Specialization for prime K
 template<int_t K, int_t M, typename VType, int S, class W1>
 struct DFTk_inp_adapter<K,Loki::Typelist<Pair<SInt<K>, SInt<1> >, Loki::NullType>,M,VType,S,W1,true> 
-: public DFTk_inp<K, M*2, VType, S> { };
+: public Loki::Select<(K > RaderThreshold), 
+    DFTk_inp_rader<K, M*2, VType, S>, DFTk_inp<K, M*2, VType, S> >::Result { };
 
 // Specialization for K=4
 // template<int_t M, typename VType, int S, class W1>
@@ -355,7 +344,8 @@ struct DFTk_inp_adapter<K, Loki::Typelist<Pair<SInt<KF>, SInt<0> >, Tail>, M, VT
 // Specialization for prime K
 template<int_t K, int_t M, typename VType, int S, class W1>
 struct DFTk_inp_adapter<K,Loki::Typelist<Pair<SInt<K>, SInt<1> >, Loki::NullType>,M,VType,S,W1,false> 
-: public DFTk_inp<K, M, VType, S> { };
+: public Loki::Select<(K > RaderThreshold), 
+    DFTk_inp_rader<K, M, VType, S>, DFTk_inp<K, M, VType, S> >::Result { };
 
 ///////////////////////////////////////////////////
 
@@ -375,6 +365,10 @@ class DFTk_x_Im_T_omp<NThreads,K,KFact,M,Step,VType,S,W1,SimpleSpec,true>
 
 //   typedef Permutation<K,typename Loki::TL::Reverse<KFact>::Result> Perm;
    typedef Permutation<K,KFact> Perm;
+   typedef DFTk_x_Im_T_simd<K,M,VType,S,W1,(SIMDRadixOMP<K,KFact>::value && Step == 1)> SpecSIMD;
+   SpecSIMD spec_simd;
+   // the vectorized stage has its own table
+   TwiddleTable<K,SimpleSpec,T,S,(TwiddleTables && !SpecSIMD::Enabled)> m_tab;
 
 public:
   /*  // This has low performance benefit and doesn't work for powers other than 2
@@ -408,8 +402,27 @@ public:
    // Sequential version
    void apply(T* data) 
    {
+      if (spec_simd.Enabled) {
+	spec_simd.apply(data);
+	return;
+      }
      // M times call to spec_inp_a.apply()
       spec_inp_a.apply(data);
+
+      if (TwiddleTables) {
+	// W^k of the column goes to the position Perm(k)-1 as in ComputeRoots
+	T wr[K-1], wi[K-1];
+	for (int_t j=1; j<SimpleSpec; ++j) {
+	  for (int_t k=1; k<K; ++k) {
+	    const int_t kk = Perm::value(k) - 1;
+	    wr[kk] = m_tab.get(k)[2*j];
+	    wi[kk] = m_tab.get(k)[2*j+1];
+	  }
+	  spec_inp_a.apply(data + j*S2, wr, wi);
+	}
+	return;
+      }
+
       ComputeRoots<K,VType,W1,Perm> roots;
 
       spec_inp_a.apply(data+S2, roots.get_real(), roots.get_imag());
@@ -441,6 +454,12 @@ class DFTk_x_Im_T_omp<NThreads,K,KFact,M,Step,VType,S,W1,SimpleSpec,false>
    DFTk_inp_adapter<K,KFact,M,VType,S,W> spec_inp_a;
 
    typedef Permutation<K,KFact> Perm;
+   // the storage of CT is interleaved
+   typedef typename InterleavedType<VType>::Result IVType;
+   typedef DFTk_x_Im_T_simd<K,M,IVType,S,W1,(SIMDRadixOMP<K,KFact>::value && Step == 1),GetISA<VType>::value> SpecSIMD;
+   SpecSIMD spec_simd;
+   // the vectorized stage has its own table
+   TwiddleTable<K,SimpleSpec,typename IVType::ValueType,S,(TwiddleTables && !SpecSIMD::Enabled)> m_tab;
 
 public:
   
@@ -475,8 +494,23 @@ public:
    // Sequential version
    void apply(CT* data) 
    {
+      if (spec_simd.Enabled) {
+	spec_simd.apply(reinterpret_cast<typename IVType::ValueType*>(data));
+	return;
+      }
      // M times call to spec_inp_a.apply()
       spec_inp_a.apply(data);
+
+      if (TwiddleTables) {
+	CT w[K-1];
+	for (int_t j=1; j<SimpleSpec; ++j) {
+	  for (int_t k=1; k<K; ++k)
+	    w[Perm::value(k) - 1] = CT(m_tab.get(k)[2*j], m_tab.get(k)[2*j+1]);
+	  spec_inp_a.apply(data + j*Step, w);
+	}
+	return;
+      }
+
       ComputeRootsStd<K,VType,W1,Perm> roots;
 
       spec_inp_a.apply(data+Step, roots.get());
@@ -537,6 +571,15 @@ template<int_t N, typename Head, typename Tail, typename VType, int S, class W1,
 class InTimeOOP_omp<1,N,Loki::Typelist<Head,Tail>,VType,S,W1,LastK> 
 : public InTimeOOP<N,Loki::Typelist<Head,Tail>,VType,S,W1,LastK> {};
 
+// Prime N is not split between threads
+template<int_t NThreads, int_t N, typename VType, int S, class W1, int_t LastK>
+class InTimeOOP_omp<NThreads,N,Loki::Typelist<Pair<SInt<N>, SInt<1> >, Loki::NullType>,VType,S,W1,LastK> 
+: public InTimeOOP<N,Loki::Typelist<Pair<SInt<N>, SInt<1> >, Loki::NullType>,VType,S,W1,LastK> {};
+
+template<int_t N, typename VType, int S, class W1, int_t LastK>
+class InTimeOOP_omp<1,N,Loki::Typelist<Pair<SInt<N>, SInt<1> >, Loki::NullType>,VType,S,W1,LastK> 
+: public InTimeOOP<N,Loki::Typelist<Pair<SInt<N>, SInt<1> >, Loki::NullType>,VType,S,W1,LastK> {};
+
 
 /** \class {GFFT::GFFTswap2OMP}
 \brief Binary reordering parallelized by %OpenMP
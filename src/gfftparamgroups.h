@@ -49,6 +49,15 @@ struct TransformTypeGroup
   typedef DFT Default;
 };
 
+/// \brief Lists all acceptable dimensions of transform
+/// \ingroup gr_groups
+struct DimensionGroup
+{
+  typedef TYPELIST_3(SIntID<1>,SIntID<2>,SIntID<3>) FullList;
+  static const uint_t Length = 3;
+  typedef SIntID<1> Default;
+};
+
 /// \brief Lists all acceptable parallelization methods
 /// \ingroup gr_groups
 struct ParallelizationGroup
@@ -59,6 +68,16 @@ struct ParallelizationGroup
   typedef Serial Default;
 };
 
+/// \brief Lists all plan variants, which can be selected by measurement
+/// \ingroup gr_groups
+struct PlanVariantGroup
+{
+  typedef TYPELIST_6(DefaultPlan,DescendingPlan,SplitPlan,DescendingSplitPlan,
+                     Radix8Plan,Radix16Plan) FullList;
+  static const uint_t Length = 6;
+  typedef DefaultPlan Default;
+};
+
 // /// \brief Lists all acceptable decimation versions
 // /// \ingroup gr_groups
 // struct DecimationGroup
@@ -0,0 +1,124 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gfftplan_h
+#define __gfftplan_h
+
+/** \file
+    \brief Measurement-based selection of plan variants
+*/
+
+#include "sint.h"
+#include "gfftpolicy.h"
+#include "gfftwisdom.h"
+
+#include <vector>
+#include <algorithm>
+#include <ctime>
+
+namespace GFFT {
+
+/// Planner flags of GenerateTransform::CreateTransformObject
+/** ESTIMATE takes the default plan variant or the one stored in PlanWisdom.
+    MEASURE times all compiled plan variants on this machine and takes the fastest one.
+*/
+enum PlannerFlag { ESTIMATE = 0, MEASURE = 1 };
+
+/// Minimum time in seconds to measure a plan variant
+static const double PlanMeasureTime = 1e-3;
+
+/// Wall-clock time in seconds
+inline double plan_wtime()
+{
+#ifdef _OPENMP
+   return omp_get_wtime();
+#else
+   return static_cast<double>(std::clock())/CLOCKS_PER_SEC;
+#endif
+}
+
+
+/// Measures the execution time of a transform object
+/*!
+\tparam ObjectType abstract interface of the transforms (AbstractFFT_inp, AbstractFFT_oop)
+
+The transform runs repeatedly, until PlanMeasureTime is exceeded.
+The best time per call out of several rounds is returned.
+*/
+template<class ObjectType>
+struct PlanTimer;
+
+template<typename T>
+struct PlanTimer<AbstractFFT_oop<T> >
+{
+   static double apply(AbstractFFT_oop<T>* obj, const int_t n)
+   {
+      // the out-of-place real-valued transforms write n+1 complex bins
+      std::vector<T> src(2*n+2), dst(2*n+2);
+      for (int_t i=0; i<2*n; ++i)
+	src[i] = T(i % 7);
+
+      obj->fft(&src[0], &dst[0]);
+      double best = 0;
+      for (int round=0; round<3; ++round) {
+	int_t reps = 0;
+	const double t0 = plan_wtime();
+	double t;
+	do {
+	  obj->fft(&src[0], &dst[0]);
+	  ++reps;
+	  t = plan_wtime() - t0;
+	} while (t < PlanMeasureTime);
+	t /= reps;
+	if (round == 0 || t < best) best = t;
+      }
+      return best;
+   }
+};
+
+// The data are restored before each call, since repeated in-place transforms
+// would overflow. The copy costs the same for all variants.
+template<typename T>
+struct PlanTimer<AbstractFFT_inp<T> >
+{
+   static double apply(AbstractFFT_inp<T>* obj, const int_t n)
+   {
+      std::vector<T> src(2*n), data(2*n);
+      for (int_t i=0; i<2*n; ++i)
+	src[i] = T(i % 7);
+
+      data = src;
+      obj->fft(&data[0]);
+      double best = 0;
+      for (int round=0; round<3; ++round) {
+	int_t reps = 0;
+	const double t0 = plan_wtime();
+	double t;
+	do {
+	  std::copy(src.begin(), src.end(), data.begin());
+	  obj->fft(&data[0]);
+	  ++reps;
+	  t = plan_wtime() - t0;
+	} while (t < PlanMeasureTime);
+	t /= reps;
+	if (round == 0 || t < best) best = t;
+      }
+      return best;
+   }
+};
+
+
+}  //namespace GFFT
+
+#endif /*__gfftplan_h*/
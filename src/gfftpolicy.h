@@ -27,6 +27,7 @@
 
 #include "sint.h"
 #include "twiddles.h"
+#include "gfftcaller.h"
 
 static const int_t SwitchToOMP = (1<<8);
 
@@ -45,6 +46,16 @@ template<typename T>
 class AbstractFFT_inp {
 public:
    virtual void fft(T*) = 0;
+
+   /// Runs howmany transforms of the arrays data + i*dist, i=0,...,howmany-1
+   /** The distance dist is counted in elements of type T.
+   */
+   virtual void fft_many(T* data, const int_t howmany, const int_t dist)
+   {
+      for (int_t i = 0; i < howmany; ++i)
+	fft(data + i*dist);
+   }
+
    virtual ~AbstractFFT_inp() {}
 };
 
@@ -52,9 +63,31 @@ template<typename T>
 class AbstractFFT_oop {
 public:
    virtual void fft(const T*, T*) = 0;
+
+   /// Runs howmany transforms from src + i*dist to dst + i*dist, i=0,...,howmany-1
+   /** The distance dist is counted in elements of type T.
+   */
+   virtual void fft_many(const T* src, T* dst, const int_t howmany, const int_t dist)
+   {
+      for (int_t i = 0; i < howmany; ++i)
+	fft(src + i*dist, dst + i*dist);
+   }
+
    virtual ~AbstractFFT_oop() {}
 };
 
+/// Abstract interface of the transforms of split-complex data
+/** The real and imaginary parts are stored in separate arrays.
+    The transform is in-place, if dst_re == src_re and dst_im == src_im.
+*/
+template<typename T>
+class AbstractFFT_split {
+public:
+   virtual void fft(const T* src_re, const T* src_im, T* dst_re, T* dst_im) = 0;
+
+   virtual ~AbstractFFT_split() {}
+};
+
 /** \class Empty
 \brief Abstract empty base class
 
@@ -134,6 +167,44 @@ struct COMPLEX_FLOAT {
    static const char* name() { return "std::complex<float>"; }
 };
 
+/*! \brief Split-complex double precision type representation
+\ingroup gr_params
+
+The real and imaginary parts are stored in two separate arrays of double.
+These transforms are planned at runtime by RuntimeSplit.
+*/
+struct SPLIT_DOUBLE {
+   static const id_t ID = 4;
+   typedef double base_type;
+   typedef double ValueType;
+   typedef long double TempType;
+#ifdef __x86_64
+   static const int Accuracy = 2;
+#else  
+   static const int Accuracy = 4;
+#endif
+   static const char* name() { return "split double"; }
+};
+
+/*! \brief Split-complex single precision type representation
+\ingroup gr_params
+
+The real and imaginary parts are stored in two separate arrays of float.
+These transforms are planned at runtime by RuntimeSplit.
+*/
+struct SPLIT_FLOAT {
+   static const id_t ID = 5;
+   typedef float base_type;
+   typedef float ValueType;
+   typedef double TempType;
+#ifdef __x86_64
+   static const int Accuracy = 1;
+#else
+   static const int Accuracy = 2;
+#endif
+   static const char* name() { return "split float"; }
+};
+
 
 /*! \brief In-place algorithm 
 \ingroup gr_params
@@ -147,18 +218,28 @@ struct IN_PLACE {
    };
 
    template<int_t N, typename NFact, typename VType,
-            typename Parall, typename Direction>
+            typename Parall, typename Direction, int_t Radix = Power2Radix>
    class List {
       typedef typename VType::ValueType T;
       typedef typename Parall::template ActualParall<N>::Result NewParall;
       typedef typename NewParall::template Swap<NFact,T>::Result Swap;
       typedef typename GetFirstRoot<N,Direction::Sign,VType::Accuracy>::Result W1;
-      typedef InTime_omp<NewParall::NParProc,N,NFact,VType,Direction::Sign,W1> InT;
+      // the binary reordering is the same for the grouped powers of two
+      typedef typename GroupPowersOf2<NFact,Radix>::Result RFact;
+      typedef InTime_omp<NewParall::NParProc,N,RFact,VType,Direction::Sign,W1> InT;
+      // in-place transforms are available for the powers of primes only
+      static const bool PrimePower = (Loki::TL::Length<typename Factorization<SIntID<N>, SInt>::Result>::value == 1);
+      typedef TYPELIST_3(Swap,InT,Direction) InpList;
+      typedef TYPELIST_1(InPlaceNotAllowed<T>) NotAllowedList;
    public:
-      typedef TYPELIST_3(Swap,InT,Direction) Result;
+      typedef typename Loki::Select<PrimePower, InpList, NotAllowedList>::Result Result;
    };
    
-   template<typename FuncList, typename T>
+   /// Transform object
+   /** \tparam BatchThreads number of threads to split a batch of transforms.
+       It is 1, if a single transform is already parallelized.
+   */
+   template<typename FuncList, typename T, int_t BatchThreads = 1>
    struct Function : public Interface<T>::Result
    {
       FuncList m_run;
@@ -167,6 +248,13 @@ struct IN_PLACE {
       { 
 	m_run.apply(data); 
       }
+
+      void fft_many(T* data, const int_t howmany, const int_t dist) 
+      { 
+	#pragma omp parallel for schedule(static) num_threads(BatchThreads) if(BatchThreads > 1 && howmany > 1)
+	for (int_t i = 0; i < howmany; ++i)
+	  m_run.apply(data + i*dist); 
+      }
    };
    
    static const char* name() { return "in-place"; }
@@ -189,16 +277,21 @@ struct OUT_OF_PLACE {
 //    };
 
    template<int_t N, typename NFact, typename VType,
-            typename Parall, typename Direction>
+            typename Parall, typename Direction, int_t Radix = Power2Radix>
    class List {
       typedef typename Parall::template ActualParall<N>::Result NewParall;
       typedef typename GetFirstRoot<N,Direction::Sign,VType::Accuracy>::Result W1;
-      typedef InTimeOOP_omp<NewParall::NParProc,N,NFact,VType,Direction::Sign,W1> InT;
+      typedef typename GroupPowersOf2<NFact,Radix>::Result RFact;
+      typedef InTimeOOP_omp<NewParall::NParProc,N,RFact,VType,Direction::Sign,W1> InT;
    public:
        typedef TYPELIST_2(InT,Direction) Result;
    };
 
-   template<typename FuncList, typename T>
+   /// Transform object
+   /** \tparam BatchThreads number of threads to split a batch of transforms.
+       It is 1, if a single transform is already parallelized.
+   */
+   template<typename FuncList, typename T, int_t BatchThreads = 1>
    struct Function : public Interface<T>::Result
    {
       FuncList m_run;
@@ -207,6 +300,13 @@ struct OUT_OF_PLACE {
       { 
 	m_run.apply(src, dst); 
       }
+
+      void fft_many(const T* src, T* dst, const int_t howmany, const int_t dist) 
+      { 
+	#pragma omp parallel for schedule(static) num_threads(BatchThreads) if(BatchThreads > 1 && howmany > 1)
+	for (int_t i = 0; i < howmany; ++i)
+	  m_run.apply(src + i*dist, dst + i*dist); 
+      }
    };
 
    static const char* name() { return "out-of-place"; }
@@ -226,13 +326,13 @@ struct DFT {
    typedef IDFT Inverse;
 
    template<int_t N, typename NFact, typename VType,
-            typename Parall, typename Place>
+            typename Parall, typename Place, int_t Radix = Power2Radix>
    class Algorithm {
       typedef typename VType::ValueType T;
       typedef Forward<N,T> Direction;
 //      typedef typename GetFirstRoot<N,Direction::Sign,VType::Accuracy>::Result W1;
    public:
-      typedef typename Place::template List<N,NFact,VType,Parall,Direction>::Result Result;
+      typedef typename Place::template List<N,NFact,VType,Parall,Direction,Radix>::Result Result;
    };
 };
 
@@ -245,17 +345,23 @@ struct IDFT {
    typedef DFT Inverse;
 
    template<int_t N, typename NFact, typename VType,
-            typename Parall, typename Place>
+            typename Parall, typename Place, int_t Radix = Power2Radix>
    class Algorithm {
       typedef typename VType::ValueType T;
       typedef Backward<N,T> Direction;
    public:
-      typedef typename Place::template List<N,NFact,VType,Parall,Direction>::Result Result;
+      typedef typename Place::template List<N,NFact,VType,Parall,Direction,Radix>::Result Result;
    };
 };
 
 /*! \brief Forward real-valued discrete Fourier transform
 \ingroup gr_params
+
+The transform of the length N takes 2N real values.
+The in-place transform returns N complex bins, where the real
+Nyquist term is packed into the imaginary part of the bin 0.
+The out-of-place transform returns N+1 complex bins, so that
+the destination must hold 2N+2 real values.
 */
 struct RDFT {
    static const id_t ID = 2;
@@ -263,12 +369,12 @@ struct RDFT {
    typedef IRDFT Inverse;
 
    template<int_t N, typename NFact, typename VType,
-            typename Parall, typename Place>
+            typename Parall, typename Place, int_t Radix = Power2Radix>
    class Algorithm {
       typedef typename VType::ValueType T;
       typedef Forward<N,T> Direction;
       typedef Separate<N,VType,Direction::Sign> Separator;
-      typedef typename Place::template List<N,NFact,VType,Parall,Direction>::Result TList;
+      typedef typename Place::template List<N,NFact,VType,Parall,Direction,Radix>::Result TList;
    public:
       typedef typename Loki::TL::Append<TList,Separator>::Result Result;
    };
@@ -276,6 +382,11 @@ struct RDFT {
 
 /*! \brief Inverse real-valued discrete Fourier transform
 \ingroup gr_params
+
+The input bins are packed as the output of RDFT of the same place.
+The out-of-place transform does not modify the source. It prepares the data
+in the destination, which is then transformed in-place, if the length is
+a power of a prime, otherwise in a temporary array.
 */
 struct IRDFT {
    static const id_t ID = 3;
@@ -283,29 +394,46 @@ struct IRDFT {
    typedef RDFT Inverse;
 
    template<int_t N, typename NFact, typename VType,
-            typename Parall, typename Place>
+            typename Parall, typename Place, int_t Radix = Power2Radix>
    class Algorithm {
       typedef typename VType::ValueType T;
       typedef Backward<N,T> Direction;
       typedef Separate<N,VType,Direction::Sign> Separator;
-      typedef typename Place::template List<N,NFact,VType,Parall,Direction>::Result TList;
+      typedef typename Place::template List<N,NFact,VType,Parall,Direction,Radix>::Result TList;
+      // in-place transforms are available for the powers of primes only,
+      // otherwise the data are prepared in a temporary array
+      static const bool PrimePower = (Loki::TL::Length<typename Factorization<SIntID<N>, SInt>::Result>::value == 1);
+      static const int_t Len = Loki::TypeTraits<T>::isStdFundamental ? 2*N : N;
+      typedef typename IN_PLACE::template List<N,NFact,VType,Parall,Direction,Radix>::Result InpList;
+      typedef TYPELIST_2(Separator,InPlaceOnDst<Caller<InpList> >) InpOutOfPlaceList;
+      typedef ThroughTemp<Separator,Caller<TList>,T,Len> TempCaller;
+      typedef TYPELIST_1(TempCaller) TempOutOfPlaceList;
+      typedef typename Loki::Select<PrimePower, InpOutOfPlaceList, TempOutOfPlaceList>::Result OutOfPlaceList;
    public:
-      typedef Loki::Typelist<Separator,TList> Result;
+      typedef typename Loki::Select<(Place::ID == OUT_OF_PLACE::ID),
+         OutOfPlaceList, Loki::Typelist<Separator,TList> >::Result Result;
    };
 };
 
 /*! \brief Forward discrete cosine transform, type 1
 \ingroup gr_params
+
+The real-to-real transforms are computed at runtime (see RuntimeR2R).
+Flip defines, how a sine transform is computed by the cosine one:
+0 - no reordering, 1 - the input with alternating signs and the output
+in reverse order, -1 - the input in reverse order and the output with
+alternating signs.
 */
 struct DCT1 {
    static const id_t ID = 4;
+   static const int Flip = 0;
    typedef IDCT1 Inverse;
 
    template<unsigned long N, typename T>
    struct Direction : public Forward<N,T> {};
 
    template<int_t N, typename NFact, typename VType,
-            class Parall, class Place>
+            class Parall, class Place, int_t Radix = Power2Radix>
    struct Algorithm {
 //      typedef TList Result;
    };
@@ -316,13 +444,14 @@ struct DCT1 {
 */
 struct IDCT1 {
    static const id_t ID = 5;
+   static const int Flip = 0;
    typedef DCT1 Inverse;
 
    template<unsigned long N, typename T>
    struct Direction : public Backward<N,T> {};
 
    template<int_t N, typename NFact, typename VType,
-            class Parall, class Place>
+            class Parall, class Place, int_t Radix = Power2Radix>
    struct Algorithm {
 //      typedef TList Result;
    };
@@ -333,13 +462,14 @@ struct IDCT1 {
 */
 struct DCT2 {
    static const id_t ID = 6;
+   static const int Flip = 0;
    typedef IDCT2 Inverse;
 
    template<unsigned long N, typename T>
    struct Direction : public Forward<N,T> {};
 
    template<int_t N, typename NFact, typename VType,
-            class Parall, class Place>
+            class Parall, class Place, int_t Radix = Power2Radix>
    struct Algorithm {
       //typedef TList Result;
    };
@@ -350,18 +480,109 @@ struct DCT2 {
 */
 struct IDCT2 {
    static const id_t ID = 7;
+   static const int Flip = 0;
    typedef DCT2 Inverse;
 
    template<unsigned long N, typename T>
    struct Direction : public Backward<N,T> {};
 
    template<int_t N, typename NFact, typename VType,
-            class Parall, class Place>
+            class Parall, class Place, int_t Radix = Power2Radix>
    struct Algorithm {
       //typedef TList Result;
    };
 };
 
+/*! \brief Discrete cosine transform, type 3
+\ingroup gr_params
+
+DCT3 is the inverse of DCT2 scaled by 2n.
+*/
+struct DCT3 {
+   static const id_t ID = 8;
+   static const int Flip = 0;
+};
+
+/*! \brief Discrete cosine transform, type 4
+\ingroup gr_params
+
+DCT4 is the inverse of itself scaled by 2n.
+*/
+struct DCT4 {
+   static const id_t ID = 9;
+   static const int Flip = 0;
+};
+
+/*! \brief Discrete sine transform, type 1
+\ingroup gr_params
+
+DST1 is the inverse of itself scaled by 2(n+1).
+*/
+struct DST1 {
+   static const id_t ID = 10;
+   static const int Flip = 0;
+};
+
+/*! \brief Discrete sine transform, type 2
+\ingroup gr_params
+*/
+struct DST2 {
+   static const id_t ID = 11;
+   static const int Flip = 1;
+};
+
+/*! \brief Discrete sine transform, type 3
+\ingroup gr_params
+
+DST3 is the inverse of DST2 scaled by 2n.
+*/
+struct DST3 {
+   static const id_t ID = 12;
+   static const int Flip = -1;
+};
+
+/*! \brief Discrete sine transform, type 4
+\ingroup gr_params
+
+DST4 is the inverse of itself scaled by 2n.
+*/
+struct DST4 {
+   static const id_t ID = 13;
+   static const int Flip = -1;
+};
+
+/*! \brief Variant of the transform plan
+\tparam Descending order of the factors: false - ascending primes (default), true - descending
+\tparam Split number of data chunks per thread in the parallelized stage of %OpenMP transforms
+\tparam Radix largest radix of the grouped powers of two: 4, 8 or 16 (see GroupPowersOf2)
+
+The variants produce the same result, but may differ in performance
+on a particular machine. GenerateTransform instantiates the variants
+from its parameter Variant and selects the fastest one, if the transform
+object is created with the planner flag MEASURE.
+\sa PlanVariantGroup
+\ingroup gr_params
+*/
+template<bool Descending, int_t Split, int_t Radix = Power2Radix>
+struct PlanVariant {
+   static const id_t ID = 2*(Split-1) + (Descending ? 1 : 0) + 8*(IsMultipleOf<Radix,2>::value-2);
+   static const int_t SplitFactor = Split;
+   static const int_t MaxRadix = Radix;
+
+   template<typename NFact>
+   struct Order {
+      typedef typename Loki::Select<Descending, 
+        typename Loki::TL::Reverse<NFact>::Result, NFact>::Result Result;
+   };
+};
+
+typedef PlanVariant<false,1> DefaultPlan;
+typedef PlanVariant<true,1>  DescendingPlan;
+typedef PlanVariant<false,2> SplitPlan;
+typedef PlanVariant<true,2>  DescendingSplitPlan;
+typedef PlanVariant<false,1,8>  Radix8Plan;
+typedef PlanVariant<false,1,16> Radix16Plan;
+
 /*! \brief %Serial (single-core) implementation of transform
 \sa OpenMP
 \ingroup gr_params
@@ -383,8 +604,10 @@ struct Serial {
       typedef GFFTswap2<M,P,T> Result;
    };
 
-   template<typename N>
-   struct Factor : public Factorization<N, SInt> {};
+   template<typename N, class Variant = DefaultPlan>
+   struct Factor {
+      typedef typename Variant::template Order<typename Factorization<N, SInt>::Result>::Result Result;
+   };
 
    template<typename T>
    void apply(T*) { }
@@ -410,7 +633,7 @@ struct OpenMP {
    };
    
    // used for in-place transforms only
-   template<typename NFact, typename T>
+   template<typename NFact, typename T, typename Tail = typename NFact::Tail>
    struct Swap {
       static const uint_t M = NFact::Tail::Head::first::value;
       static const uint_t P = IsMultipleOf<NFact::Head::first::value,M>::value 
@@ -419,14 +642,20 @@ struct OpenMP {
 //       typedef GFFTswap2OMP<NT,M,P,T> Result;
    };
 
-   template<typename N>
+   // prime length is not split between threads
+   template<typename NFact, typename T>
+   struct Swap<NFact,T,Loki::NullType> : public Serial::Swap<NFact,T> {};
+
+   template<typename N, class Variant = DefaultPlan>
    struct Factor {
-      static const int_t G = GCD<SInt<N::value>, SInt<NT> >::Result::value;
+      static const int_t NS = NT*Variant::SplitFactor;
+      static const int_t G = GCD<SInt<N::value>, SInt<NS> >::Result::value;
       typedef typename Factorization<SIntID<N::value/G>, SInt>::Result NFact1;
-      typedef ExtractFactor<NT/G, NFact1> EF;
+      typedef ExtractFactor<NS/G, NFact1> EF;
       typedef Pair<SInt<G*EF::value>,SInt<1> > NParall;
-      typedef Loki::Typelist<NParall,typename EF::Result> Multithreaded;
-      typedef typename Factorization<N, SInt>::Result Singlethreaded;
+      typedef typename Variant::template Order<typename EF::Result>::Result NFactRest;
+      typedef Loki::Typelist<NParall,NFactRest> Multithreaded;
+      typedef typename Variant::template Order<typename Factorization<N, SInt>::Result>::Result Singlethreaded;
       static const bool C = ((N::value > NT*NT) && (N::value >= SwitchToOMP));
       typedef typename Loki::Select<C,   // Condition to turn on multithreaded mode
 	  Multithreaded, Singlethreaded>::Result Result;
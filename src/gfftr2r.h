@@ -0,0 +1,363 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gfftr2r_h
+#define __gfftr2r_h
+
+/** \file
+    \brief Real-to-real transforms: discrete cosine and sine transforms of types I-IV
+
+    All the transforms are computed in O(n log n) operations by
+    the real-valued FFT (RuntimeRealOOP) or the complex one (RuntimeInTimeOOP)
+    with the pre- and post-processing in O(n).
+    The forward transforms are not scaled and defined as in FFTW
+    (REDFT00,...,RODFT11), e.g. DCT-II:
+    \f[ Y_k = 2\sum_{j=0}^{n-1} x_j \cos\frac{\pi(j+1/2)k}{n} \f]
+    IDCT1 and IDCT2 are the inverse transforms of DCT1 and DCT2 including the scaling.
+*/
+
+#include "gfftruntime.h"
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace GFFT {
+
+/// DCT-I and DST-I by the real FFT of the length n-1 or n+1
+/*!
+\tparam VType value type with interleaved storage
+\tparam Sine false - DCT-I, true - DST-I
+
+The symmetric extensions of the length 2(n-1) or 2(n+1) are avoided:
+the pairs of elements j and m-j are combined with sin(pi*j/m) into m real values,
+whose FFT gives the even outputs directly and the odd ones as the running sums
+(as cosft1 and sinft in Numerical Recipes).
+*/
+template<typename VType, bool Sine>
+class RuntimeDCT1
+{
+   typedef typename VType::ValueType T;
+   typedef typename VType::TempType LocalVType;
+
+   const int_t m_n, m_m;
+   RuntimeRealOOP<VType,1> m_fft;
+   std::vector<T> m_c, m_s;   // cos and sin of pi*j/m, j = 0,...,m/2
+   ScratchPool<T> m_buf;      // m values and m/2+1 bins
+
+public:
+   RuntimeDCT1(const int_t n, const int nthreads = 1)
+   : m_n(n), m_m(Sine ? n+1 : n-1), m_fft(m_m, nthreads), m_c(m_m/2+1), m_s(m_m/2+1),
+     m_buf(2*m_m+2)
+   {
+      const LocalVType pi = M_PI;
+      for (int_t j=0; 2*j<=m_m; ++j) {
+	m_c[j] = std::cos(pi*j/m_m);
+	m_s[j] = std::sin(pi*j/m_m);
+      }
+   }
+
+   int_t length() const { return m_n; }
+
+   void apply(const T* src, T* dst)
+   {
+      const int_t m = m_m;
+      ScratchBuffer<T> buf(m_buf);
+      T* a = buf.get();
+      T* bins = a + m;
+      if (Sine) {
+	// f_j = src[j-1], j = 1,...,m-1
+	a[0] = 0;
+	int_t j = 1;
+	for (; j<m-j; ++j) {
+	  const T y1 = m_s[j]*(src[j-1] + src[m-j-1]);
+	  const T y2 = 0.5*(src[j-1] - src[m-j-1]);
+	  a[j] = y1 + y2;
+	  a[m-j] = y1 - y2;
+	}
+	if (j == m-j) a[j] = 2*src[j-1];
+	m_fft.apply(a, bins);
+	// dst[k-1] = 2*F_k
+	T sum = bins[0];
+	dst[0] = sum;
+	for (int_t k=1; 2*k<m; ++k) {
+	  dst[2*k-1] = -2*bins[2*k+1];
+	  if (2*k+1 < m) {
+	    sum += 2*bins[2*k];
+	    dst[2*k] = sum;
+	  }
+	}
+      }
+      else {
+	T sum = src[0] - src[m];
+	a[0] = 0.5*(src[0] + src[m]);
+	int_t j = 1;
+	for (; j<m-j; ++j) {
+	  const T y1 = 0.5*(src[j] + src[m-j]);
+	  const T y2 = src[j] - src[m-j];
+	  a[j] = y1 - m_s[j]*y2;
+	  a[m-j] = y1 + m_s[j]*y2;
+	  sum += 2*m_c[j]*y2;
+	}
+	if (j == m-j) a[j] = src[j];
+	m_fft.apply(a, bins);
+	dst[0] = 2*bins[0];
+	if (m > 0) dst[1] = sum;
+	for (int_t k=1; 2*k<=m; ++k) {
+	  dst[2*k] = 2*bins[2*k];
+	  if (2*k+1 <= m) {
+	    sum -= 2*bins[2*k+1];
+	    dst[2*k+1] = sum;
+	  }
+	}
+      }
+   }
+};
+
+
+/// DCT-II and DCT-III by the real FFT of the same length (Makhoul's algorithm)
+/*!
+\tparam VType value type with interleaved storage
+\tparam S 1 - DCT-II, -1 - DCT-III
+
+DCT-II transforms the reordered data v = (x0, x2, x4,..., x5, x3, x1)
+and takes the real parts of the bins multiplied by exp(-i*pi*k/2n).
+DCT-III runs these steps in reverse order.
+*/
+template<typename VType, int S>
+class RuntimeDCT2
+{
+   typedef typename VType::ValueType T;
+   typedef typename VType::TempType LocalVType;
+
+   const int_t m_n;
+   RuntimeRealOOP<VType,S> m_fft;
+   std::vector<T> m_c, m_s;   // cos and sin of pi*k/2n, k = 0,...,n/2
+   ScratchPool<T> m_buf;      // n values and n/2+1 bins
+
+public:
+   RuntimeDCT2(const int_t n, const int nthreads = 1)
+   : m_n(n), m_fft(n, nthreads), m_c(n/2+1), m_s(n/2+1), m_buf(2*n+2)
+   {
+      const LocalVType pi = M_PI;
+      for (int_t k=0; k<=n/2; ++k) {
+	m_c[k] = std::cos(pi*k/(2*n));
+	m_s[k] = std::sin(pi*k/(2*n));
+      }
+   }
+
+   int_t length() const { return m_n; }
+
+   void apply(const T* src, T* dst)
+   {
+      const int_t n = m_n;
+      ScratchBuffer<T> buf(m_buf);
+      T* v = buf.get();
+      T* bins = v + n;
+      if (S == 1) {
+	for (int_t j=0; 2*j<n; ++j)   v[j] = src[2*j];
+	for (int_t j=0; 2*j+1<n; ++j) v[n-1-j] = src[2*j+1];
+	m_fft.apply(v, bins);
+	dst[0] = 2*bins[0];
+	for (int_t k=1; 2*k<=n; ++k) {
+	  const T vr = bins[2*k], vi = bins[2*k+1];
+	  dst[k] = 2*(vr*m_c[k] + vi*m_s[k]);
+	  dst[n-k] = 2*(vr*m_s[k] - vi*m_c[k]);
+	}
+      }
+      else {
+	for (int_t k=0; 2*k<=n; ++k) {
+	  const T a = src[k], b = (k > 0) ? src[n-k] : 0;
+	  bins[2*k]   = a*m_c[k] + b*m_s[k];
+	  bins[2*k+1] = a*m_s[k] - b*m_c[k];
+	}
+	m_fft.apply(bins, v);
+	for (int_t j=0; 2*j<n; ++j)   dst[2*j] = v[j];
+	for (int_t j=0; 2*j+1<n; ++j) dst[2*j+1] = v[n-1-j];
+      }
+   }
+};
+
+
+/// DCT-IV by the complex FFT
+/*!
+\tparam VType value type with interleaved storage
+
+An even length n is transformed by the complex FFT of the length n/2
+of z_j = (x_2j + i*x_(n-1-2j))*exp(-i*pi*(4j+1)/4n), whose bins Z_k
+multiplied by exp(-i*pi*k/n) give Y_2k and -Y_(n-1-2k) as the real and
+imaginary parts. An odd length n is transformed by the complex FFT of
+the length 2n of x_j*exp(-i*pi*j/2n) padded with zeros.
+*/
+template<typename VType>
+class RuntimeDCT4
+{
+   typedef typename VType::ValueType T;
+   typedef typename VType::TempType LocalVType;
+
+   const int_t m_n, m_m;
+   RuntimeInTimeOOP<VType,1> m_fft;
+   std::vector<T> m_pr, m_pi, m_qr, m_qi;   // pre- and post-twiddles
+   ScratchPool<T> m_buf;   // input and output of the complex FFT
+
+public:
+   RuntimeDCT4(const int_t n, const int nthreads = 1)
+   : m_n(n), m_m((n%2 == 0) ? n/2 : 2*n), m_fft(m_m, nthreads), m_buf(4*m_m)
+   {
+      const LocalVType pi = M_PI;
+      const int_t np = (n%2 == 0) ? n/2 : n;
+      m_pr.resize(np);  m_pi.resize(np);
+      m_qr.resize(np);  m_qi.resize(np);
+      for (int_t j=0; j<np; ++j) {
+	const LocalVType a = (n%2 == 0) ? pi*(4*j+1)/(4*n) : pi*j/(2*n);
+	const LocalVType b = (n%2 == 0) ? pi*j/n : pi*(2*j+1)/(4*n);
+	m_pr[j] = std::cos(a);  m_pi[j] = -std::sin(a);
+	m_qr[j] = std::cos(b);  m_qi[j] = -std::sin(b);
+      }
+   }
+
+   int_t length() const { return m_n; }
+
+   void apply(const T* src, T* dst)
+   {
+      const int_t n = m_n;
+      ScratchBuffer<T> buf(m_buf);
+      T* z = buf.get();
+      T* w = z + 2*m_m;
+      if (n%2 == 0) {
+	for (int_t j=0; j<m_m; ++j) {
+	  const T re = src[2*j], im = src[n-1-2*j];
+	  z[2*j]   = re*m_pr[j] - im*m_pi[j];
+	  z[2*j+1] = re*m_pi[j] + im*m_pr[j];
+	}
+	m_fft.apply(z, w);
+	for (int_t k=0; k<m_m; ++k) {
+	  const T re = w[2*k], im = w[2*k+1];
+	  dst[2*k]       =  2*(re*m_qr[k] - im*m_qi[k]);
+	  dst[n-1-2*k]   = -2*(re*m_qi[k] + im*m_qr[k]);
+	}
+      }
+      else {
+	for (int_t j=0; j<n; ++j) {
+	  z[2*j]   = src[j]*m_pr[j];
+	  z[2*j+1] = src[j]*m_pi[j];
+	}
+	// the buffers of the pool are not zero-filled
+	std::fill(z + 2*n, z + 2*m_m, T(0));
+	m_fft.apply(z, w);
+	for (int_t k=0; k<n; ++k)
+	  dst[k] = 2*(w[2*k]*m_qr[k] - w[2*k+1]*m_qi[k]);
+      }
+   }
+};
+
+
+/// Real-to-real transform of a runtime length
+/*!
+\tparam VType value type with interleaved storage: DOUBLE, FLOAT
+\tparam Type type of transform: DCT1, IDCT1, DCT2, IDCT2, DCT3, DCT4, DST1, DST2, DST3, DST4
+\tparam Plan algorithm: RuntimeDCT1, RuntimeDCT2 or RuntimeDCT4
+
+The sine transforms of types II-IV are computed by the cosine ones as
+DST-II(x)_k = DCT-II(x')_(n-1-k), where x'_j = (-1)^j x_j, and
+DST-III(x)_k = (-1)^k DCT-III(xr)_k, DST-IV(x)_k = (-1)^k DCT-IV(xr)_k,
+where xr is x in reverse order.
+\sa RuntimeR2R
+*/
+template<class VType, class Type, class Plan>
+class R2RTransform : public AbstractFFT_oop<typename VType::ValueType>
+{
+   typedef typename VType::ValueType T;
+
+   Plan m_plan;
+   const T m_scale;
+   ScratchPool<T> m_buf;   // the reordered input
+
+public:
+   R2RTransform(const int_t n, const int nthreads, const T scale = 1)
+   : m_plan(n, nthreads), m_scale(scale), m_buf(n) { }
+
+   void fft(const T* src, T* dst)
+   {
+      const int_t n = m_plan.length();
+      if (Type::Flip == 0 && src != dst)
+	m_plan.apply(src, dst);
+      else {
+	ScratchBuffer<T> buf(m_buf);
+	T* tmp = buf.get();
+	if (Type::Flip == -1)
+	  std::reverse_copy(src, src+n, tmp);
+	else
+	  std::copy(src, src+n, tmp);
+	if (Type::Flip == 1)
+	  for (int_t j=1; j<n; j+=2) tmp[j] = -tmp[j];
+	m_plan.apply(tmp, dst);
+      }
+      if (Type::Flip == 1)
+	std::reverse(dst, dst+n);
+      if (Type::Flip == -1)
+	for (int_t k=1; k<n; k+=2) dst[k] = -dst[k];
+      if (m_scale != T(1))
+	for (int_t k=0; k<n; ++k) dst[k] *= m_scale;
+   }
+};
+
+
+/// Creates the real-to-real transform objects
+/*!
+\tparam VType value type with interleaved storage: DOUBLE, FLOAT
+
+The transforms are out-of-place, although src and dst may be the same array.
+The length n counts the real values, DCT1 and IDCT1 need n > 1.
+The number of threads is derived from the parallelization id
+as in OpenMP<NT>::ID = NT-1.
+
+Usage:
+\code
+GFFT::AbstractFFT_oop<double>* dct = GFFT::RuntimeR2R<GFFT::DOUBLE>::Create(n, GFFT::DCT2::ID);
+dct->fft(x, y);
+\endcode
+*/
+template<class VType>
+struct RuntimeR2R
+{
+   typedef typename VType::ValueType T;
+   typedef AbstractFFT_oop<T> ObjectType;
+
+   static ObjectType* Create(const int_t n, const int_t trans_id, const int_t parall_id = 0)
+   {
+      if (n < 1)
+	return 0;
+      const int nt = static_cast<int>(parall_id) + 1;
+      switch (trans_id) {
+	case DCT1::ID:
+	  return (n > 1) ? new R2RTransform<VType,DCT1,RuntimeDCT1<VType,false> >(n, nt) : 0;
+	case IDCT1::ID:
+	  return (n > 1) ? new R2RTransform<VType,IDCT1,RuntimeDCT1<VType,false> >(n, nt, T(1)/(2*(n-1))) : 0;
+	case DCT2::ID:  return new R2RTransform<VType,DCT2,RuntimeDCT2<VType,1> >(n, nt);
+	case IDCT2::ID: return new R2RTransform<VType,IDCT2,RuntimeDCT2<VType,-1> >(n, nt, T(1)/(2*n));
+	case DCT3::ID:  return new R2RTransform<VType,DCT3,RuntimeDCT2<VType,-1> >(n, nt);
+	case DCT4::ID:  return new R2RTransform<VType,DCT4,RuntimeDCT4<VType> >(n, nt);
+	case DST1::ID:  return new R2RTransform<VType,DST1,RuntimeDCT1<VType,true> >(n, nt);
+	case DST2::ID:  return new R2RTransform<VType,DST2,RuntimeDCT2<VType,1> >(n, nt);
+	case DST3::ID:  return new R2RTransform<VType,DST3,RuntimeDCT2<VType,-1> >(n, nt);
+	case DST4::ID:  return new R2RTransform<VType,DST4,RuntimeDCT4<VType> >(n, nt);
+	default: return 0;
+      }
+   }
+};
+
+}  //namespace GFFT
+
+#endif /*__gfftr2r_h*/
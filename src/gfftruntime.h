@@ -0,0 +1,1238 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gfftruntime_h
+#define __gfftruntime_h
+
+/** \file
+    \brief Mixed-radix FFT of a length known at runtime only
+
+    These classes are used by GenerateTransform as a fallback for
+    the transform lengths, which are not compiled into its NList.
+*/
+
+#include "gfftalg.h"
+#include "gfftfactor.h"
+#include "gfftpolicy.h"
+#include "gfftcache.h"
+#include "gfftmultidim.h"
+#include "gffttranspose.h"
+#include "gfftcpu.h"
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include <omp.h>
+
+namespace GFFT {
+
+/// Abstract radix of the runtime mixed-radix algorithm
+/*!
+\tparam T value type of the interleaved data array
+
+Both functions operate on interleaved complex data.
+leaf() computes DFT of length K reading the input with the stride \a sstride
+and writing the result with the stride \a dstride (both in units of T,
+where 2 means contiguous complex numbers).
+stage() performs the scaled DFT(K) x Im with the twiddle factors wr, wi
+for the columns j = jb,...,je-1, where the complex elements of data
+are \a dstride apart. The twiddles of the column j
+start at the position (j-1)*(K-1).
+*/
+template<typename T>
+class RuntimeRadix
+{
+public:
+   virtual void leaf(const T* src, const int_t sstride, T* dst, const int_t dstride) = 0;
+   virtual void stage(T* data, const int_t M, const int_t jb, const int_t je,
+                      const T* wr, const T* wi, const int_t dstride) = 0;
+   virtual ~RuntimeRadix() {}
+};
+
+
+/// Runtime radix using the compile-time kernel DFTk_inp<K,2,...>
+/*!
+\tparam K radix
+\tparam VType value type with interleaved storage
+\tparam S sign of the transform: 1 - forward, -1 - backward
+
+The K strided elements of a column are gathered into a local array,
+so that the same short-radix kernels as in the compile-time algorithms are used.
+*/
+template<int_t K, typename VType, int S>
+class RuntimeRadixK : public RuntimeRadix<typename VType::ValueType>
+{
+   typedef typename VType::ValueType T;
+   static const int_t K2 = 2*K;
+   DFTk_inp<K,2,VType,S> spec_inp;
+
+   static void gather(const T* data, const int_t stride, T* buf)
+   {
+      for (int_t i=0; i<K; ++i) {
+	buf[2*i]   = data[i*stride];
+	buf[2*i+1] = data[i*stride+1];
+      }
+   }
+   static void scatter(const T* buf, const int_t stride, T* data)
+   {
+      for (int_t i=0; i<K; ++i) {
+	data[i*stride]   = buf[2*i];
+	data[i*stride+1] = buf[2*i+1];
+      }
+   }
+
+public:
+   void leaf(const T* src, const int_t sstride, T* dst, const int_t dstride)
+   {
+      if (dstride == 2) {
+	gather(src, sstride, dst);
+	spec_inp.apply(dst);
+	return;
+      }
+      T buf[K2];
+      gather(src, sstride, buf);
+      spec_inp.apply(buf);
+      scatter(buf, dstride, dst);
+   }
+
+   void stage(T* data, const int_t M, const int_t jb, const int_t je,
+              const T* wr, const T* wi, const int_t dstride)
+   {
+      T buf[K2];
+      const int_t M2 = M*dstride;
+      int_t j = jb;
+      if (j == 0) {
+	gather(data, M2, buf);
+	spec_inp.apply(buf);
+	scatter(buf, M2, data);
+	++j;
+      }
+      for (; j<je; ++j) {
+	T* d = data + j*dstride;
+	const int_t tw = (j-1)*(K-1);
+	gather(d, M2, buf);
+	spec_inp.apply(buf, wr + tw, wi + tw);
+	scatter(buf, M2, d);
+      }
+   }
+};
+
+
+/// Runtime radix for an odd prime, which is not instantiated at compile-time
+/*!
+\tparam VType value type with interleaved storage
+\tparam S sign of the transform: 1 - forward, -1 - backward
+
+This is the same algorithm as in the general DFTk_inp,
+where the length and the stride are runtime parameters.
+*/
+template<typename VType, int S>
+class RuntimeRadixOdd : public RuntimeRadix<typename VType::ValueType>
+{
+   typedef typename VType::ValueType T;
+   typedef typename VType::TempType LocalVType;
+   static const int_t StackLimit = 64;
+
+   const int_t m_n, m_k;
+   const LocalVType *m_c, *m_s;   // shared cos and sin of 2*pi*i/n, i = 1,...,(n-1)/2
+
+   void _transform(T* data, const int_t M, T* sr, T* si, T* dr, T* di)
+   {
+      const int_t NM = m_n*M;
+      for (int_t i=1; i<m_k+1; ++i) {
+	T re1(0), re2(0), im1(0), im2(0);
+	for (int_t j=0; j<m_k; ++j) {
+	  const bool sign_change = (i*(j+1) % m_n) > m_k;
+	  const int_t kk = (i+j*i)%m_n;
+	  const int_t k = (kk>m_k) ? m_n-kk-1 : kk-1;
+	  const T s1 = m_s[k]*di[j];
+	  const T s2 = m_s[k]*dr[j];
+	  re1 += m_c[k]*sr[j];
+	  im1 += m_c[k]*si[j];
+	  re2 += sign_change ? -s1 : s1;
+	  im2 -= sign_change ? -s2 : s2;
+	}
+	const int_t k = i*M;
+	data[k] = data[0] + re1 + re2;
+	data[k+1] = data[1] + im1 + im2;
+	data[NM-k] = data[0] + re1 - re2;
+	data[NM-k+1] = data[1] + im1 - im2;
+      }
+
+      for (int_t i=0; i<m_k; ++i) {
+	data[0] += sr[i];
+	data[1] += si[i];
+      }
+   }
+
+   void apply(T* data, const int_t M, T* tmp)
+   {
+      const int_t NM = m_n*M;
+      T *sr = tmp, *si = tmp+m_k, *dr = tmp+2*m_k, *di = tmp+3*m_k;
+      for (int_t i=0; i<m_k; ++i) {
+	const int_t k = (i+1)*M;
+	sr[i] = data[k]   + data[NM-k];
+	si[i] = data[k+1] + data[NM-k+1];
+	dr[i] = data[k]   - data[NM-k];
+	di[i] = data[k+1] - data[NM-k+1];
+      }
+      _transform(data, M, sr, si, dr, di);
+   }
+
+   void apply(T* data, const int_t M, const T* wr, const T* wi, T* tmp)
+   {
+      const int_t NM = m_n*M;
+      T *sr = tmp, *si = tmp+m_k, *dr = tmp+2*m_k, *di = tmp+3*m_k;
+      for (int_t i=0; i<m_k; ++i) {
+	const int_t k = (i+1)*M;
+	const T tr1 = data[k]*wr[i] - data[k+1]*wi[i];
+	const T ti1 = data[k]*wi[i] + data[k+1]*wr[i];
+	const T tr2 = data[NM-k]*wr[m_n-i-2] - data[NM-k+1]*wi[m_n-i-2];
+	const T ti2 = data[NM-k]*wi[m_n-i-2] + data[NM-k+1]*wr[m_n-i-2];
+	sr[i] = tr1 + tr2;
+	si[i] = ti1 + ti2;
+	dr[i] = tr1 - tr2;
+	di[i] = ti1 - ti2;
+      }
+      _transform(data, M, sr, si, dr, di);
+   }
+
+public:
+   RuntimeRadixOdd(const int_t n)
+   : m_n(n), m_k((n-1)/2)
+   {
+      // the imaginary parts of the roots of the opposite sign are S*sin
+      const LocalVType* w = shared_roots<LocalVType>(n, -S);
+      m_c = w + 1;
+      m_s = w + n + 1;
+   }
+
+   void leaf(const T* src, const int_t sstride, T* dst, const int_t dstride)
+   {
+      for (int_t i=0; i<m_n; ++i) {
+	dst[i*dstride]   = src[i*sstride];
+	dst[i*dstride+1] = src[i*sstride+1];
+      }
+      T buf[4*StackLimit];
+      std::vector<T> heap;
+      T* tmp = (m_k <= StackLimit) ? buf : (heap.resize(4*m_k), &heap[0]);
+      apply(dst, dstride, tmp);
+   }
+
+   void stage(T* data, const int_t M, const int_t jb, const int_t je,
+              const T* wr, const T* wi, const int_t dstride)
+   {
+      T buf[4*StackLimit];
+      std::vector<T> heap;
+      T* tmp = (m_k <= StackLimit) ? buf : (heap.resize(4*m_k), &heap[0]);
+      const int_t M2 = M*dstride;
+      int_t j = jb;
+      if (j == 0) {
+	apply(data, M2, tmp);
+	++j;
+      }
+      for (; j<je; ++j) {
+	const int_t tw = (j-1)*(m_n-1);
+	apply(data + j*dstride, M2, wr + tw, wi + tw, tmp);
+      }
+   }
+};
+
+
+template<typename VType, int S>
+RuntimeRadix<typename VType::ValueType>* CreateRuntimeRadix(const int_t k);
+
+
+/// Out-of-place decimation-in-time FFT of a runtime length
+/*!
+\tparam VType value type with interleaved storage
+\tparam S sign of the transform: 1 - forward, -1 - backward
+
+This is the runtime version of InTimeOOP. The length is factorized
+by RuntimeFactorization at construction, where also the radices and
+the twiddle factors for every stage are precomputed.
+The K strided sub-transforms of the top-level stage and its columns
+are distributed between nthreads threads, if the length is large enough.
+*/
+template<typename VType, int S>
+class RuntimeInTimeOOP
+{
+   typedef typename VType::ValueType T;
+
+   struct Stage {
+      int_t K, M;
+      RuntimeRadix<T>* radix;
+      const T *wr, *wi;   // shared twiddles
+   };
+
+   const int_t m_n;
+   const int m_nthreads;
+   std::vector<Stage> m_stages;
+
+   void rec(const int_t level, const T* src, const int_t sstride, T* dst, const int_t dstride)
+   {
+      Stage& st = m_stages[level];
+      if (st.M == 1) {
+	st.radix->leaf(src, sstride, dst, dstride);
+	return;
+      }
+      const int_t M2 = st.M*dstride;
+      for (int_t k=0; k<st.K; ++k)
+	rec(level+1, src + k*sstride, sstride*st.K, dst + k*M2, dstride);
+
+      st.radix->stage(dst, st.M, 0, st.M, &st.wr[0], &st.wi[0], dstride);
+   }
+
+   // disable copying, since radices are owned by the stages
+   RuntimeInTimeOOP(const RuntimeInTimeOOP&);
+   RuntimeInTimeOOP& operator=(const RuntimeInTimeOOP&);
+
+public:
+   RuntimeInTimeOOP(const int_t n, const int nthreads = 1)
+   : m_n(n), m_nthreads(nthreads)
+   {
+      typename RuntimeFactorization<>::FactorList factors;
+      RuntimeFactorization<>::apply(n, factors);
+
+      int_t len = n;
+      for (std::size_t f=0; f<factors.size(); ++f)
+	for (int_t p=0; p<factors[f].second; ++p) {
+	  Stage st;
+	  st.K = factors[f].first;
+	  st.M = len/st.K;
+	  st.radix = 0;
+	  st.wr = st.wi = 0;
+	  m_stages.push_back(st);
+	  len = st.M;
+	}
+
+      for (std::size_t i=0; i<m_stages.size(); ++i) {
+	Stage& st = m_stages[i];
+	st.radix = CreateRuntimeRadix<VType,S>(st.K);
+	st.wr = shared_stage_twiddles<T>(st.K, st.M, S);
+	st.wi = st.wr + (st.M-1)*(st.K-1);
+      }
+   }
+
+   ~RuntimeInTimeOOP()
+   {
+      for (std::size_t i=0; i<m_stages.size(); ++i)
+	delete m_stages[i].radix;
+   }
+
+   int_t length() const { return m_n; }
+
+   /// Transforms src into dst
+   /** \param istride, ostride distances between the complex elements 
+       of the input and the output. The strides are folded into the
+       first (leaf) and all the following stages, so no copy is made.
+   */
+   void apply(const T* src, T* dst, const int_t istride = 1, const int_t ostride = 1)
+   {
+      const int_t is = 2*istride, os = 2*ostride;
+      if (m_stages.empty()) {   // n == 1
+	dst[0] = src[0];
+	dst[1] = src[1];
+	return;
+      }
+
+      Stage& st = m_stages[0];
+      if (m_nthreads < 2 || m_n < SwitchToOMP || st.M == 1) {
+	rec(0, src, is, dst, os);
+	return;
+      }
+
+      const int_t M2 = st.M*os;
+      #pragma omp parallel num_threads(m_nthreads)
+      {
+	#pragma omp for schedule(static)
+	for (int_t k=0; k<st.K; ++k)
+	  rec(1, src + k*is, is*st.K, dst + k*M2, os);
+
+#ifdef _OPENMP
+	const int nt = omp_get_num_threads();
+	const int tid = omp_get_thread_num();
+#else
+	const int nt = 1, tid = 0;
+#endif
+	const int_t jb = st.M*tid/nt;
+	const int_t je = st.M*(tid+1)/nt;
+	st.radix->stage(dst, st.M, jb, je, &st.wr[0], &st.wi[0], os);
+      }
+   }
+};
+
+
+/// Runtime radix for a large prime using the Bluestein's algorithm
+/*!
+\tparam VType value type with interleaved storage
+\tparam S sign of the transform: 1 - forward, -1 - backward
+
+The same algorithm as in Bluestein, where the cyclic convolution
+of the power-of-two length runs by RuntimeInTimeOOP.
+*/
+template<typename VType, int S>
+class RuntimeRadixBluestein : public RuntimeRadix<typename VType::ValueType>
+{
+   typedef typename VType::ValueType T;
+
+   const int_t m_n, m_m;
+   const T *m_wr, *m_wi;  // shared chirp
+   const T* m_b;          // shared spectrum of the kernel scaled by 1/M
+   RuntimeInTimeOOP<VType,1> m_fft;
+   ScratchPool<T> m_scratch;   // two arrays of 2*m_m per call
+
+   // wr, wi are the twiddles of the elements 1,...,n-1 or null
+   void apply(const T* src, const int_t sstride, T* dst, const int_t dstride,
+              const T* wr, const T* wi)
+   {
+      const int_t M2 = 2*m_m;
+      ScratchBuffer<T> buf(m_scratch);
+      T* a = buf.get();
+      T* b = a + M2;
+      for (int_t i=0; i<m_n; ++i) {
+	T re = src[i*sstride], im = src[i*sstride+1];
+	if (wr && i > 0) {
+	  const T t = re*wr[i-1] - im*wi[i-1];
+	  im = re*wi[i-1] + im*wr[i-1];
+	  re = t;
+	}
+	a[2*i]   = re*m_wr[i] - im*m_wi[i];
+	a[2*i+1] = re*m_wi[i] + im*m_wr[i];
+      }
+      for (int_t i=2*m_n; i<M2; ++i)
+	a[i] = T(0);
+      m_fft.apply(a, b);
+
+      // conj(A*B)
+      for (int_t i=0; i<M2; i+=2) {
+	a[i]   =   b[i]*m_b[i]   - b[i+1]*m_b[i+1];
+	a[i+1] = -(b[i]*m_b[i+1] + b[i+1]*m_b[i]);
+      }
+      m_fft.apply(a, b);
+
+      for (int_t i=0; i<m_n; ++i) {
+	const T re = b[2*i], im = -b[2*i+1];
+	dst[i*dstride]   = re*m_wr[i] - im*m_wi[i];
+	dst[i*dstride+1] = re*m_wi[i] + im*m_wr[i];
+      }
+   }
+
+   static int_t convLength(const int_t n)
+   {
+      int_t m = 1;
+      while (m < 2*n-1) m *= 2;
+      return m;
+   }
+
+public:
+   RuntimeRadixBluestein(const int_t n)
+   : m_n(n), m_m(convLength(n)), m_fft(m_m), m_scratch(4*m_m)
+   {
+      m_wr = shared_bluestein<T>(m_n, m_m, S, m_fft);
+      m_wi = m_wr + m_n;
+      m_b = m_wi + m_n;
+   }
+
+   void leaf(const T* src, const int_t sstride, T* dst, const int_t dstride)
+   {
+      apply(src, sstride, dst, dstride, 0, 0);
+   }
+
+   void stage(T* data, const int_t M, const int_t jb, const int_t je,
+              const T* wr, const T* wi, const int_t dstride)
+   {
+      const int_t M2 = M*dstride;
+      for (int_t j=jb; j<je; ++j) {
+	T* d = data + j*dstride;
+	if (j == 0)
+	  apply(d, M2, d, M2, 0, 0);
+	else {
+	  const int_t tw = (j-1)*(m_n-1);
+	  apply(d, M2, d, M2, wr + tw, wi + tw);
+	}
+      }
+   }
+};
+
+
+/// Creates runtime radix for the prime factor k
+/** The primes from InitialPrimesList and 13 use the compile-time kernels,
+    the primes above BluesteinThreshold are handled by RuntimeRadixBluestein
+    and all the other primes by RuntimeRadixOdd.
+*/
+template<typename VType, int S>
+RuntimeRadix<typename VType::ValueType>* CreateRuntimeRadix(const int_t k)
+{
+   switch (k) {
+     case 2:  return new RuntimeRadixK<2,VType,S>();
+     case 3:  return new RuntimeRadixK<3,VType,S>();
+     case 5:  return new RuntimeRadixK<5,VType,S>();
+     case 7:  return new RuntimeRadixK<7,VType,S>();
+     case 11: return new RuntimeRadixK<11,VType,S>();
+     case 13: return new RuntimeRadixK<13,VType,S>();
+     default: 
+       if (k > BluesteinThreshold)
+	 return new RuntimeRadixBluestein<VType,S>(k);
+       return new RuntimeRadixOdd<VType,S>(k);
+   }
+}
+
+
+/// Minimum size in bytes of the data, from which RuntimeFallback plans the four-step algorithm
+/** If the data exceed the private cache by far, the stages of RuntimeInTimeOOP
+    stream through the main memory. The threshold is 8 times the level 2 cache
+    (the measured crossover), 16 MB if the cache size is unknown. 
+    Define GFFT_FOURSTEP_BYTES to set it at compile time.
+*/
+inline int_t four_step_bytes()
+{
+#ifdef GFFT_FOURSTEP_BYTES
+   return GFFT_FOURSTEP_BYTES;
+#else
+   static const int_t l2 = cpu_cache_size(2);
+   return (l2 > 0) ? 8*l2 : (int_t(16) << 20);
+#endif
+}
+
+/// Number of columns, which are transformed together in RuntimeFourStep
+static const int_t FourStepBlock = 8;
+
+/// Bailey's four-step FFT for the large lengths
+/*!
+\tparam VType value type with interleaved storage
+\tparam S sign of the transform: 1 - forward, -1 - backward
+
+The length n = n1*n2 is split into the factors close to sqrt(n).
+The input is the n1 x n2 matrix in row-major order.
+-# The n2 columns of the length n1 are transformed and multiplied 
+   by the twiddle factors W^(j2*k1), then stored as rows of the temporary n2 x n1 matrix.
+-# The n1 columns of the temporary matrix of the length n2 are transformed 
+   and stored as the columns of the n2 x n1 output matrix.
+
+The columns are gathered by blocks of FourStepBlock, so that every short
+transform runs in cache and the main memory is accessed in contiguous pieces.
+Both transposes are fused into the gathering and storing of the blocks,
+which are transposed by Transpose.
+The blocks are distributed between nthreads threads.
+The twiddle factors W^m are computed as W^(a*t) * W^b, m = a*t + b,
+from two tables of the length about sqrt(n).
+*/
+template<typename VType, int S>
+class RuntimeFourStep
+{
+   typedef typename VType::ValueType T;
+
+   const int_t m_n, m_n1, m_n2, m_t;
+   const int m_nthreads;
+   RuntimeInTimeOOP<VType,S> m_fft1, m_fft2;
+   std::vector<T> m_hr, m_hi, m_lr, m_li;
+   ScratchPool<T> m_tmp;      // the n2 x n1 matrix between the steps
+   ScratchPool<T> m_blocks;   // two blocks of columns for every thread
+
+   static int_t isqrt(const int_t n)
+   {
+      int_t r = static_cast<int_t>(std::sqrt(static_cast<double>(n)));
+      while (r*r > n) --r;
+      while ((r+1)*(r+1) <= n) ++r;
+      return r;
+   }
+
+   void table(std::vector<T>& wr, std::vector<T>& wi, const int_t len, const int_t step)
+   {
+      wr.resize(len);
+      wi.resize(len);
+      for (int_t i=0; i<len; ++i) {
+	long double re, im;
+	direct_root(i*step, m_n, S, re, im);
+	wr[i] = re;
+	wi[i] = im;
+      }
+   }
+
+   // the blocks of columns are transposed by a single thread
+   typedef Transpose<VType,Serial> Trans;
+
+public:
+   /// The factor n1 <= sqrt(n) of the split; it is 1, if n is prime
+   static int_t split(const int_t n)
+   {
+      int_t best = 1;
+      for (int_t d=2; d*d<=n; ++d)
+	if (n % d == 0) best = d;
+      return best;
+   }
+
+   RuntimeFourStep(const int_t n, const int nthreads = 1)
+   : m_n(n), m_n1(split(n)), m_n2(n/m_n1), m_t(isqrt(n) + 1), m_nthreads(nthreads),
+     m_fft1(m_n1), m_fft2(m_n2), m_tmp(2*n), m_blocks(4*FourStepBlock*std::max(m_n1, m_n2))
+   {
+      table(m_hr, m_hi, m_n/m_t + 1, m_t);
+      table(m_lr, m_li, m_t, 1);
+   }
+
+   int_t length() const { return m_n; }
+
+   void apply(const T* src, T* dst)
+   {
+      const int_t n12 = 2*m_n1, n22 = 2*m_n2;
+      const int_t nb1 = (m_n2 + FourStepBlock - 1)/FourStepBlock;
+      const int_t nb2 = (m_n1 + FourStepBlock - 1)/FourStepBlock;
+      ScratchBuffer<T> tmp(m_tmp);
+      T* z = tmp.get();
+
+      #pragma omp parallel num_threads(m_nthreads) if(m_nthreads > 1)
+      {
+	// every thread takes its pair of blocks a, b from the pool of the plan
+	ScratchBuffer<T> buf(m_blocks);
+	T* a = buf.get();
+	T* b = a + m_blocks.size()/2;
+
+	// columns of the length n1 with the twiddles into the rows of z
+	#pragma omp for schedule(static)
+	for (int_t blk=0; blk<nb1; ++blk) {
+	  const int_t c0 = blk*FourStepBlock;
+	  const int_t nc = std::min(FourStepBlock, m_n2 - c0);
+	  Trans::apply(src + 2*c0, a, m_n1, nc, m_n2, m_n1);
+	  for (int_t c=0; c<nc; ++c) {
+	    const int_t j2 = c0 + c;
+	    const T* bc = b + c*n12;
+	    m_fft1.apply(a + c*n12, b + c*n12);
+	    T* zr = z + j2*n12;
+	    for (int_t k1=0; k1<m_n1; ++k1) {
+	      const int_t m = j2*k1;
+	      const int_t h = m/m_t, l = m%m_t;
+	      const T wr = m_hr[h]*m_lr[l] - m_hi[h]*m_li[l];
+	      const T wi = m_hr[h]*m_li[l] + m_hi[h]*m_lr[l];
+	      zr[2*k1]   = bc[2*k1]*wr - bc[2*k1+1]*wi;
+	      zr[2*k1+1] = bc[2*k1]*wi + bc[2*k1+1]*wr;
+	    }
+	  }
+	}
+
+	// columns of z of the length n2 into the columns of dst
+	#pragma omp for schedule(static)
+	for (int_t blk=0; blk<nb2; ++blk) {
+	  const int_t c0 = blk*FourStepBlock;
+	  const int_t nc = std::min(FourStepBlock, m_n1 - c0);
+	  Trans::apply(z + 2*c0, a, m_n2, nc, m_n1, m_n2);
+	  for (int_t c=0; c<nc; ++c)
+	    m_fft2.apply(a + c*n22, b + c*n22);
+	  Trans::apply(b, dst + 2*c0, nc, m_n2, m_n2, m_n1);
+	}
+      }
+   }
+};
+
+
+/// Out-of-place real-valued FFT of any runtime length
+/*!
+\tparam VType value type with interleaved storage
+\tparam S sign of the transform: 1 - forward, -1 - backward
+
+The forward transform takes n real values and returns the n/2+1 complex
+bins of the half spectrum, the backward one takes them and returns n real
+values (not scaled). An even length n is transformed as n/2 complex numbers
+by RuntimeInTimeOOP, whose result is separated as in Separate.
+An odd length n is factorized as in RuntimeInTimeOOP. The forward stage K x M transforms the K real decimated sequences of the length M
+into their half spectra of M/2+1 bins, which are the rows of the K x (M/2+1) matrix.
+The full spectrum is Hermitian, so only the columns j <= M/2 are transformed 
+by the complex radix K, the other bins are the complex conjugates of them.
+The backward stages run the same steps in reverse order.
+The leaf radix transforms the real data by the direct sums over the
+symmetric pairs of elements, the primes above BluesteinThreshold use
+the complex radix. Thus every stage takes about half of the operations
+of the complex transform of the length n.
+*/
+template<typename VType, int S>
+class RuntimeRealOOP
+{
+   typedef typename VType::ValueType T;
+
+   // the leaf stage (M == 1) refers to cos and sin of 2*pi*i/K in wr, wi
+   struct Stage {
+      int_t K, M, H;   // H = M/2+1 bins of a row
+      int_t work;      // workspace of this and the following stages, 4K of a Bluestein leaf
+      RuntimeRadix<T>* radix;
+      const T *wr, *wi;   // shared twiddles
+   };
+
+   const int_t m_n;
+   const int m_nthreads;
+   std::vector<Stage> m_stages;
+   RuntimeInTimeOOP<VType,S>* m_half;   // even n only
+   const T *m_wr, *m_wi;                // shared W^k, k = 0,...,n/2
+   ScratchPool<T> m_ws;      // workspace of the first stage or n/2 bins of the even backward one
+   ScratchPool<T> m_local;   // workspace of the following stages for every thread
+
+   // the bins of the half-length complex transform in data into n/2+1 bins
+   void separate(T* data)
+   {
+      const int_t N = m_n/2;
+      const T re = data[0], im = data[1];
+      data[0] = re + im;
+      data[1] = 0;
+      data[2*N] = re - im;
+      data[2*N+1] = 0;
+      for (int_t k=1; 2*k<=N; ++k) {
+	T* a = data + 2*k;
+	T* b = data + 2*(N-k);
+	// E = (a + conj(b))/2, O = (a - conj(b))/2i
+	const T er = 0.5*(a[0] + b[0]), ei = 0.5*(a[1] - b[1]);
+	const T orr = 0.5*(a[1] + b[1]), oi = -0.5*(a[0] - b[0]);
+	const T tr = m_wr[k]*orr - m_wi[k]*oi;
+	const T ti = m_wr[k]*oi + m_wi[k]*orr;
+	// X_k = E + W^k*O, X_(N-k) = conj(E - W^k*O)
+	a[0] = er + tr;
+	a[1] = ei + ti;
+	b[0] = er - tr;
+	b[1] = ti - ei;
+      }
+   }
+
+   // the inverse of separate() from src into N bins of dst
+   void join(const T* src, T* dst)
+   {
+      const int_t N = m_n/2;
+      dst[0] = src[0] + src[2*N];
+      dst[1] = src[0] - src[2*N];
+      for (int_t k=1; 2*k<=N; ++k) {
+	const T* a = src + 2*k;
+	const T* b = src + 2*(N-k);
+	// E = a + conj(b), O = (a - conj(b))*W^k, Z_k = E + i*O, Z_(N-k) = conj(E) + i*conj(O)
+	const T er = a[0] + b[0], ei = a[1] - b[1];
+	const T dr = a[0] - b[0], di = a[1] + b[1];
+	const T orr = dr*m_wr[k] - di*m_wi[k];
+	const T oi = dr*m_wi[k] + di*m_wr[k];
+	dst[2*k]   = er - oi;
+	dst[2*k+1] = ei + orr;
+	dst[2*(N-k)]   = er + oi;
+	dst[2*(N-k)+1] = orr - ei;
+      }
+   }
+
+   // forward leaf: K real values with the stride s into K/2+1 bins
+   static void leaf(const Stage& st, const T* src, const int_t s, T* dst, T* ws)
+   {
+      const int_t K = st.K;
+      if (K == 2) {
+	dst[0] = src[0] + src[s];
+	dst[2] = src[0] - src[s];
+	dst[1] = dst[3] = 0;
+	return;
+      }
+      if (K > BluesteinThreshold) {
+	T* a = ws;
+	T* b = ws + 2*K;
+	for (int_t i=0; i<K; ++i) {
+	  a[2*i]   = src[i*s];
+	  a[2*i+1] = 0;
+	}
+	st.radix->leaf(a, 2, b, 2);
+	std::copy(b, b + 2*(K/2+1), dst);
+	return;
+      }
+      T sum = src[0];
+      for (int_t t=1; t<K; ++t) sum += src[t*s];
+      dst[0] = sum;
+      dst[1] = 0;
+      for (int_t i=1; i<=K/2; ++i) {
+	T re = src[0], im = 0;
+	for (int_t t=1; t<=K/2; ++t) {
+	  const int_t k = (i*t) % K;
+	  re += (src[t*s] + src[(K-t)*s])*st.wr[k];
+	  im += (src[t*s] - src[(K-t)*s])*st.wi[k];
+	}
+	dst[2*i]   = re;
+	dst[2*i+1] = -S*im;
+      }
+   }
+
+   // backward leaf: K/2+1 bins into K real values with the stride s
+   static void leaf(const Stage& st, const T* src, T* dst, const int_t s, T* ws)
+   {
+      const int_t K = st.K;
+      if (K == 2) {
+	dst[0] = src[0] + src[2];
+	dst[s] = src[0] - src[2];
+	return;
+      }
+      if (K > BluesteinThreshold) {
+	T* a = ws;
+	T* b = ws + 2*K;
+	for (int_t i=0; i<=K/2; ++i) {
+	  a[2*i]   = src[2*i];
+	  a[2*i+1] = src[2*i+1];
+	}
+	for (int_t i=K/2+1; i<K; ++i) {
+	  a[2*i]   =  src[2*(K-i)];
+	  a[2*i+1] = -src[2*(K-i)+1];
+	}
+	st.radix->leaf(a, 2, b, 2);
+	for (int_t t=0; t<K; ++t) dst[t*s] = b[2*t];
+	return;
+      }
+      for (int_t t=0; t<K; ++t) {
+	T sum = 0;
+	for (int_t i=1; i<=K/2; ++i) {
+	  const int_t k = (i*t) % K;
+	  sum += src[2*i]*st.wr[k] + S*src[2*i+1]*st.wi[k];
+	}
+	dst[t*s] = src[0] + 2*sum;
+      }
+   }
+
+   // transforms the columns jb,...,je-1 of y and stores the bins up to n/2 into dst
+   static void combine(Stage& st, T* y, const int_t jb, const int_t je, T* dst)
+   {
+      const int_t L = st.K*st.M;
+      st.radix->stage(y, st.H, jb, je, &st.wr[0], &st.wi[0], 2);
+      for (int_t j=jb; j<je; ++j)
+	for (int_t m=0; m<st.K; ++m) {
+	  const int_t q = j + m*st.M;
+	  const T* v = y + 2*(m*st.H + j);
+	  if (2*q <= L) {
+	    dst[2*q]   = v[0];
+	    dst[2*q+1] = v[1];
+	  }
+	  else if (j > 0 && 2*(st.M-j) > st.M) {  // the column M-j is not computed
+	    dst[2*(L-q)]   =  v[0];
+	    dst[2*(L-q)+1] = -v[1];
+	  }
+	}
+   }
+
+   // restores the columns jb,...,je-1 of z from the bins up to n/2 in src and transforms them
+   static void split(Stage& st, const T* src, const int_t jb, const int_t je, T* z)
+   {
+      const int_t L = st.K*st.M;
+      for (int_t j=jb; j<je; ++j) {
+	for (int_t m=0; m<st.K; ++m) {
+	  const int_t q = j + m*st.M;
+	  T* v = z + 2*(m*st.H + j);
+	  if (2*q <= L) {
+	    v[0] = src[2*q];
+	    v[1] = src[2*q+1];
+	  }
+	  else {
+	    v[0] =  src[2*(L-q)];
+	    v[1] = -src[2*(L-q)+1];
+	  }
+	}
+	// decimation in frequency: the twiddles follow the radix
+	st.radix->stage(z + 2*j, st.H, 0, 1, &st.wr[0], &st.wi[0], 2);
+	if (j == 0) continue;
+	const T* wr = &st.wr[(j-1)*(st.K-1)];
+	const T* wi = &st.wi[(j-1)*(st.K-1)];
+	for (int_t m=1; m<st.K; ++m) {
+	  T* v = z + 2*(m*st.H + j);
+	  const T re = v[0]*wr[m-1] - v[1]*wi[m-1];
+	  v[1] = v[0]*wi[m-1] + v[1]*wr[m-1];
+	  v[0] = re;
+	}
+      }
+   }
+
+   void forward(const int_t level, const T* src, const int_t sstride, T* dst, T* ws)
+   {
+      Stage& st = m_stages[level];
+      if (st.M == 1) {
+	leaf(st, src, sstride, dst, ws);
+	return;
+      }
+      const int_t H2 = 2*st.H;
+      for (int_t k=0; k<st.K; ++k)
+	forward(level+1, src + k*sstride, sstride*st.K, ws + k*H2, ws + st.K*H2);
+      combine(st, ws, 0, st.H, dst);
+   }
+
+   void backward(const int_t level, const T* src, T* dst, const int_t dstride, T* ws)
+   {
+      Stage& st = m_stages[level];
+      if (st.M == 1) {
+	leaf(st, src, dst, dstride, ws);
+	return;
+      }
+      const int_t H2 = 2*st.H;
+      split(st, src, 0, st.H, ws);
+      for (int_t k=0; k<st.K; ++k)
+	backward(level+1, ws + k*H2, dst + k*dstride, dstride*st.K, ws + st.K*H2);
+   }
+
+   // disable copying, since radices are owned by the stages
+   RuntimeRealOOP(const RuntimeRealOOP&);
+   RuntimeRealOOP& operator=(const RuntimeRealOOP&);
+
+public:
+   RuntimeRealOOP(const int_t n, const int nthreads = 1)
+   : m_n(n), m_nthreads(nthreads), m_half(0), m_wr(0), m_wi(0)
+   {
+      if (n % 2 == 0) {
+	m_half = new RuntimeInTimeOOP<VType,S>(n/2, nthreads);
+	m_wr = shared_roots<T>(n, S);
+	m_wi = m_wr + n;
+	if (S == -1)
+	  m_ws.resize(n);
+	return;
+      }
+
+      typename RuntimeFactorization<>::FactorList factors;
+      RuntimeFactorization<>::apply(n, factors);
+
+      int_t len = n;
+      for (std::size_t f=0; f<factors.size(); ++f)
+	for (int_t p=0; p<factors[f].second; ++p) {
+	  Stage st;
+	  st.K = factors[f].first;
+	  st.M = len/st.K;
+	  st.H = st.M/2 + 1;
+	  st.work = 0;
+	  st.radix = 0;
+	  st.wr = st.wi = 0;
+	  m_stages.push_back(st);
+	  len = st.M;
+	}
+
+      int_t work = 0;
+      for (std::size_t i=m_stages.size(); i-- > 0; ) {
+	Stage& st = m_stages[i];
+	st.radix = CreateRuntimeRadix<VType,S>(st.K);
+	if (st.M == 1) {
+	  work = (st.K > BluesteinThreshold) ? 4*st.K : 0;
+	  st.work = work;
+	  // sin with the positive sign are the roots of the sign -1
+	  st.wr = shared_roots<T>(st.K, -1);
+	  st.wi = st.wr + st.K;
+	  continue;
+	}
+	work += 2*st.K*st.H;
+	st.work = work;
+	// the twiddles of the columns j = 1,...,H-1 are the first ones of the complex stage
+	st.wr = shared_stage_twiddles<T>(st.K, st.M, S);
+	st.wi = st.wr + (st.M-1)*(st.K-1);
+      }
+      if (!m_stages.empty()) {
+	m_ws.resize(m_stages[0].work);
+	if (m_stages.size() > 1)
+	  m_local.resize(std::max<int_t>(m_stages[1].work, 1));
+      }
+   }
+
+   ~RuntimeRealOOP()
+   {
+      delete m_half;
+      for (std::size_t i=0; i<m_stages.size(); ++i)
+	delete m_stages[i].radix;
+   }
+
+   int_t length() const { return m_n; }
+
+   /// Forward: n real values of src into n/2+1 bins of dst, backward: vice versa
+   void apply(const T* src, T* dst)
+   {
+      if (m_half) {
+	if (S == 1) {
+	  m_half->apply(src, dst);
+	  separate(dst);
+	}
+	else {
+	  ScratchBuffer<T> z(m_ws);
+	  join(src, z.get());
+	  m_half->apply(z.get(), dst);
+	}
+	return;
+      }
+      if (m_stages.empty()) {   // n == 1
+	dst[0] = src[0];
+	if (S == 1) dst[1] = 0;
+	return;
+      }
+
+      Stage& st = m_stages[0];
+      ScratchBuffer<T> ws(m_ws);
+      if (m_nthreads < 2 || m_n < SwitchToOMP || st.M == 1) {
+	if (S == 1)
+	  forward(0, src, 1, dst, ws.get());
+	else
+	  backward(0, src, dst, 1, ws.get());
+	return;
+      }
+
+      // the rows and the columns of the top-level stage are shared by the threads
+      const int_t H2 = 2*st.H;
+      T* y = ws.get();
+      #pragma omp parallel num_threads(m_nthreads)
+      {
+	// the stages below the top level run in a workspace of the thread
+	ScratchBuffer<T> local(m_local);
+#ifdef _OPENMP
+	const int nt = omp_get_num_threads();
+	const int tid = omp_get_thread_num();
+#else
+	const int nt = 1, tid = 0;
+#endif
+	const int_t jb = st.H*tid/nt;
+	const int_t je = st.H*(tid+1)/nt;
+	if (S == 1) {
+	  #pragma omp for schedule(static)
+	  for (int_t k=0; k<st.K; ++k)
+	    forward(1, src + k, st.K, y + k*H2, local.get());
+	  combine(st, y, jb, je, dst);
+	}
+	else {
+	  split(st, src, jb, je, y);
+	  #pragma omp barrier
+	  #pragma omp for schedule(static)
+	  for (int_t k=0; k<st.K; ++k)
+	    backward(1, y + k*H2, dst + k, st.K, local.get());
+	}
+      }
+   }
+};
+
+
+/// Real-valued transform of a runtime length implementing the interface of Place
+/*!
+\tparam VType value type
+\tparam Type type of transform: RDFT, IRDFT
+\tparam Place IN_PLACE, OUT_OF_PLACE
+
+The length n counts the real values. The out-of-place transform
+returns (RDFT) or takes (IRDFT) n/2+1 complex bins as the compiled
+out-of-place RDFT. The in-place transform is available for even n only, 
+where the bins are packed as in the compiled in-place RDFT. It goes through
+a scratch buffer of the plan.
+\sa RuntimeRealOOP, RuntimeReal
+*/
+template<class VType, class Type, class Place>
+class RealTransform;
+
+template<class VType, class Type>
+class RealTransform<VType,Type,OUT_OF_PLACE>
+: public OUT_OF_PLACE::Interface<typename VType::ValueType>::Result
+{
+   typedef typename VType::ValueType T;
+   typedef typename InterleavedType<VType>::Result IVType;
+   typedef typename IVType::ValueType BT;
+
+   RuntimeRealOOP<IVType,Type::Sign> m_plan;
+
+public:
+   RealTransform(const int_t n, const int nthreads) : m_plan(n, nthreads) { }
+
+   void fft(const T* src, T* dst)
+   {
+      BT* d = reinterpret_cast<BT*>(dst);
+      m_plan.apply(reinterpret_cast<const BT*>(src), d);
+      if (Type::Sign == -1) {
+	const int_t n = m_plan.length();
+	for (BT* i=d; i<d+n; ++i) *i/=n;
+      }
+   }
+};
+
+template<class VType, class Type>
+class RealTransform<VType,Type,IN_PLACE>
+: public IN_PLACE::Interface<typename VType::ValueType>::Result
+{
+   typedef typename VType::ValueType T;
+   typedef typename InterleavedType<VType>::Result IVType;
+   typedef typename IVType::ValueType BT;
+
+   RuntimeRealOOP<IVType,Type::Sign> m_plan;
+   ScratchPool<BT> m_buf;   // n/2+1 bins
+
+public:
+   RealTransform(const int_t n, const int nthreads) : m_plan(n, nthreads), m_buf(n+2) { }
+
+   void fft(T* data)
+   {
+      const int_t n = m_plan.length();
+      BT* d = reinterpret_cast<BT*>(data);
+      ScratchBuffer<BT> buf(m_buf);
+      BT* tmp = buf.get();
+      if (Type::Sign == 1) {
+	m_plan.apply(d, tmp);
+	std::copy(tmp, tmp + n, d);
+	d[1] = tmp[n];
+      }
+      else {
+	std::copy(d, d+n, tmp);
+	tmp[1] = tmp[n+1] = 0;
+	tmp[n] = d[1];
+	m_plan.apply(tmp, d);
+	for (BT* i=d; i<d+n; ++i) *i/=n;
+      }
+   }
+};
+
+
+/// %Transform of a runtime length implementing the interface of Place
+/*!
+\tparam VType value type
+\tparam Type type of transform: DFT, IDFT
+\tparam Place IN_PLACE, OUT_OF_PLACE
+
+The in-place version copies the input into a scratch buffer of the plan
+and transforms it back into the input array.
+\tparam Plan algorithm: RuntimeInTimeOOP or RuntimeFourStep
+\sa RuntimeInTimeOOP, GenerateTransform
+*/
+template<class VType, class Type, class Place,
+template<typename,int> class Plan = RuntimeInTimeOOP>
+class RuntimeTransform;
+
+template<class VType, class Type, template<typename,int> class Plan>
+class RuntimeTransform<VType,Type,OUT_OF_PLACE,Plan>
+: public OUT_OF_PLACE::Interface<typename VType::ValueType>::Result
+{
+   typedef typename VType::ValueType T;
+   typedef typename InterleavedType<VType>::Result IVType;
+   typedef typename IVType::ValueType BT;
+
+   Plan<IVType,Type::Sign> m_plan;
+
+public:
+   RuntimeTransform(const int_t n, const int nthreads) : m_plan(n, nthreads) { }
+
+   void fft(const T* src, T* dst)
+   {
+      BT* d = reinterpret_cast<BT*>(dst);
+      m_plan.apply(reinterpret_cast<const BT*>(src), d);
+      if (Type::Sign == -1) {
+	const int_t n = m_plan.length();
+	for (BT* i=d; i<d+2*n; ++i) *i/=n;
+      }
+   }
+};
+
+template<class VType, class Type, template<typename,int> class Plan>
+class RuntimeTransform<VType,Type,IN_PLACE,Plan>
+: public IN_PLACE::Interface<typename VType::ValueType>::Result
+{
+   typedef typename VType::ValueType T;
+   typedef typename InterleavedType<VType>::Result IVType;
+   typedef typename IVType::ValueType BT;
+
+   Plan<IVType,Type::Sign> m_plan;
+   ScratchPool<BT> m_buf;
+
+public:
+   RuntimeTransform(const int_t n, const int nthreads) : m_plan(n, nthreads), m_buf(2*n) { }
+
+   void fft(T* data)
+   {
+      const int_t n = m_plan.length();
+      BT* d = reinterpret_cast<BT*>(data);
+      ScratchBuffer<BT> tmp(m_buf);
+      std::copy(d, d+2*n, tmp.get());
+      m_plan.apply(tmp.get(), d);
+      if (Type::Sign == -1)
+	for (BT* i=d; i<d+2*n; ++i) *i/=n;
+   }
+};
+
+
+/// Creates runtime transform objects for the lengths not compiled into GenerateTransform
+/*!
+\tparam VType value type
+\tparam Place IN_PLACE, OUT_OF_PLACE
+
+The real-valued transforms (RDFT, IRDFT) of the length n take 2n real values
+as the compiled ones and are computed by RealTransform.
+The data from four_step_bytes() are transformed by RuntimeFourStep.
+The multi-dimensional transforms of the length n in every dimension
+are built by MultiDimTransform from the serial one-dimensional runtime transform.
+The number of threads is derived from the parallelization id
+as in OpenMP<NT>::ID = NT-1.
+*/
+template<class VType, class Place>
+struct RuntimeFallback
+{
+   typedef typename Place::template Interface<typename VType::ValueType>::Result ObjectType;
+
+   static ObjectType* Create(const int_t n, const int_t vtype_id, const int_t trans_id,
+                             const int_t dim, const int_t parall_id, const int_t place_id)
+   {
+      if (n < 1 || vtype_id != VType::ID || place_id != Place::ID || dim < 1)
+	return 0;
+      const int nthreads = static_cast<int>(parall_id) + 1;
+      if (trans_id == DFT::ID)
+	return create<DFT>(n, dim, nthreads);
+      if (trans_id == IDFT::ID)
+	return create<IDFT>(n, dim, nthreads);
+      if (dim > 1)
+	return 0;
+      if (trans_id == RDFT::ID)
+	return new RealTransform<VType,RDFT,Place>(2*n, nthreads);
+      if (trans_id == IRDFT::ID)
+	return new RealTransform<VType,IRDFT,Place>(2*n, nthreads);
+      return 0;
+   }
+
+private:
+   template<class Type>
+   static ObjectType* create(const int_t n, const int_t dim, const int nthreads)
+   {
+      if (dim == 1) {
+	typedef typename InterleavedType<VType>::Result IVType;
+	if (n*2*static_cast<int_t>(sizeof(typename IVType::ValueType)) >= four_step_bytes() 
+	    && RuntimeFourStep<IVType,1>::split(n) >= FourStepBlock)
+	  return new RuntimeTransform<VType,Type,Place,RuntimeFourStep>(n, nthreads);
+	return new RuntimeTransform<VType,Type,Place>(n, nthreads);
+      }
+      typedef RuntimeTransform<VType,Type,OUT_OF_PLACE> Line;
+      return new MultiDimTransform<VType,Place,Line>(n, dim, nthreads, new Line(n, 1));
+   }
+};
+
+
+/// Creates real-valued transform objects of any length
+/*!
+\tparam VType value type with interleaved storage: DOUBLE, FLOAT
+
+Unlike RDFT and IRDFT of GenerateTransform, the length n counts the real values,
+so that the odd lengths are available too. The forward transform (RDFT) 
+returns n/2+1 complex bins, the backward one (IRDFT) takes them back.
+The number of threads is derived from the parallelization id
+as in OpenMP<NT>::ID = NT-1.
+
+Usage:
+\code
+GFFT::AbstractFFT_oop<double>* fft = GFFT::RuntimeReal<GFFT::DOUBLE>::Create(45, GFFT::RDFT::ID);
+fft->fft(x, bins);   // 45 real values into 23 complex bins
+\endcode
+*/
+template<class VType>
+struct RuntimeReal
+{
+   typedef AbstractFFT_oop<typename VType::ValueType> ObjectType;
+
+   static ObjectType* Create(const int_t n, const int_t trans_id, const int_t parall_id = 0)
+   {
+      if (n < 1)
+	return 0;
+      const int nthreads = static_cast<int>(parall_id) + 1;
+      if (trans_id == RDFT::ID)
+	return new RealTransform<VType,RDFT,OUT_OF_PLACE>(n, nthreads);
+      if (trans_id == IRDFT::ID)
+	return new RealTransform<VType,IRDFT,OUT_OF_PLACE>(n, nthreads);
+      return 0;
+   }
+};
+
+}  //namespace GFFT
+
+#endif /*__gfftruntime_h*/
@@ -0,0 +1,689 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gfftsimd_h
+#define __gfftsimd_h
+
+/** \file
+    \brief Vectorized scaled DFT stages
+
+    The kernels of every instruction set level (ISALevel) are compiled
+    with the target attributes of their functions, so that they do not
+    depend on the flags of the compiler. The value types without ISAType
+    use DefaultISA, the highest level enabled by the flags of the compiler
+    (-msse2, -mavx2 -mfma, -mavx512f or -march=native).
+    Define GFFT_NO_SIMD to use the scalar code only.
+*/
+
+#include "twiddles.h"
+#include "gfftfactor.h"
+#include "gfftcpu.h"
+#include <algorithm>
+
+#if !defined(GFFT_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+#define GFFT_SIMD_X86
+#define GFFT_TARGET(isa) __attribute__((target(isa)))
+#define GFFT_FORCEINLINE inline __attribute__((always_inline))
+#elif !defined(GFFT_NO_SIMD) && defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#define GFFT_SIMD_X86
+#define GFFT_TARGET(isa)
+#define GFFT_FORCEINLINE __forceinline
+#else
+#define GFFT_TARGET(isa)
+#define GFFT_FORCEINLINE inline
+#endif
+
+// full unrolling of the loops over the elements of a short kernel,
+// so that the elements stay in the registers
+#if defined(__clang__)
+#define GFFT_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__) && (__GNUC__ >= 8)
+#define GFFT_UNROLL _Pragma("GCC unroll 16")
+#else
+#define GFFT_UNROLL
+#endif
+
+#ifdef GFFT_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace GFFT {
+
+/// Instruction set level of the kernels of the value types without ISAType
+#if defined(GFFT_SIMD_X86) && defined(__AVX512F__)
+static const int DefaultISA = ISA_AVX512;
+#elif defined(GFFT_SIMD_X86) && defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+static const int DefaultISA = ISA_AVX2;
+#elif defined(GFFT_SIMD_X86) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+static const int DefaultISA = ISA_SSE2;
+#else
+static const int DefaultISA = ISA_GENERIC;
+#endif
+
+/// Value type VType, whose kernels are vectorized for the instruction set level ISA
+/*!
+The transforms of ISAType<VType,ISA> with different ISA are different instantiations,
+so they can be compiled into one program and selected at runtime (GenerateTransformISA).
+The ID and the other properties are the ones of VType.
+*/
+template<class VType, int ISA>
+struct ISAType : public VType { };
+
+/// Instruction set level of the value type
+template<class VType>
+struct GetISA {
+   static const int value = DefaultISA;
+};
+
+template<class VType, int ISA>
+struct GetISA<ISAType<VType,ISA> > {
+   static const int value = ISA;
+};
+
+
+/// Pack of complex numbers in the interleaved storage
+/*!
+\tparam T base type: double or float
+\tparam ISA instruction set level
+
+Width is the number of the complex numbers in a register, 0 if there is no
+vector register for T. The functions load and store Width complex numbers
+at any address, add, subtract and multiply them as complex numbers,
+scale by a real number and multiply by -i. addS<Sg>(a, b) is a + Sg*b.
+
+The register R is wrapped into the struct V. The kernel bodies have no target
+attributes, they are inlined into the entry functions of SIMDTarget.
+A struct is passed through the memory for every instruction set, so the calls
+from the bodies do not depend on the ABI of the vector types (-Wpsabi).
+After inlining V stays in the register.
+*/
+template<typename T, int ISA>
+struct SIMDComplex {
+   static const int Width = 0;
+};
+
+/// One complex number with the interface of SIMDComplex
+template<typename T>
+struct ScalarComplex
+{
+   struct V { T re, im; };
+   static const int Width = 1;
+
+   static V load(const T* p) { V a; a.re = p[0]; a.im = p[1]; return a; }
+   static void store(T* p, const V& a) { p[0] = a.re; p[1] = a.im; }
+   static V set(const T re, const T im) { V a; a.re = re; a.im = im; return a; }
+   static V zero() { return set(0, 0); }
+   static V add(const V& a, const V& b) { return set(a.re + b.re, a.im + b.im); }
+   static V sub(const V& a, const V& b) { return set(a.re - b.re, a.im - b.im); }
+   template<int Sg>
+   static V addS(const V& a, const V& b) { return (Sg > 0) ? add(a, b) : sub(a, b); }
+   static V scale(const V& a, const T c) { return set(a.re*c, a.im*c); }
+   static V mul(const V& a, const V& w) { return set(a.re*w.re - a.im*w.im, a.re*w.im + a.im*w.re); }
+   static V mulmi(const V& a) { return set(a.im, -a.re); }
+};
+
+#ifdef GFFT_SIMD_X86
+
+template<>
+struct SIMDComplex<double,ISA_AVX512>
+{
+   typedef __m512d R;
+   struct V { R r; };
+   static const int Width = 4;
+
+   static GFFT_TARGET("avx512f") V wrap(const R a) { V v; v.r = a; return v; }
+   static GFFT_TARGET("avx512f") V load(const double* p) { return wrap(_mm512_loadu_pd(p)); }
+   static GFFT_TARGET("avx512f") void store(double* p, const V a) { _mm512_storeu_pd(p, a.r); }
+   static GFFT_TARGET("avx512f") V set(const double re, const double im) { return wrap(_mm512_setr_pd(re, im, re, im, re, im, re, im)); }
+   static GFFT_TARGET("avx512f") V zero() { return wrap(_mm512_setzero_pd()); }
+   static GFFT_TARGET("avx512f") V add(const V a, const V b) { return wrap(_mm512_add_pd(a.r, b.r)); }
+   static GFFT_TARGET("avx512f") V sub(const V a, const V b) { return wrap(_mm512_sub_pd(a.r, b.r)); }
+   template<int Sg>
+   static GFFT_TARGET("avx512f") V addS(const V a, const V b) { return (Sg > 0) ? add(a, b) : sub(a, b); }
+   static GFFT_TARGET("avx512f") V scale(const V a, const double c) { return wrap(_mm512_mul_pd(a.r, _mm512_set1_pd(c))); }
+   static GFFT_TARGET("avx512f") V mul(const V a, const V w)
+   {
+      const R t = _mm512_mul_pd(_mm512_shuffle_pd(a.r, a.r, 0x55), _mm512_shuffle_pd(w.r, w.r, 0xFF));
+      return wrap(_mm512_fmaddsub_pd(a.r, _mm512_shuffle_pd(w.r, w.r, 0x00), t));
+   }
+   static GFFT_TARGET("avx512f") V mulmi(const V a) { return wrap(_mm512_mul_pd(_mm512_shuffle_pd(a.r, a.r, 0x55), set(1, -1).r)); }
+};
+
+template<>
+struct SIMDComplex<float,ISA_AVX512>
+{
+   typedef __m512 R;
+   struct V { R r; };
+   static const int Width = 8;
+
+   static GFFT_TARGET("avx512f") V wrap(const R a) { V v; v.r = a; return v; }
+   static GFFT_TARGET("avx512f") V load(const float* p) { return wrap(_mm512_loadu_ps(p)); }
+   static GFFT_TARGET("avx512f") void store(float* p, const V a) { _mm512_storeu_ps(p, a.r); }
+   static GFFT_TARGET("avx512f") V set(const float re, const float im)
+   {
+      return wrap(_mm512_setr_ps(re, im, re, im, re, im, re, im, re, im, re, im, re, im, re, im));
+   }
+   static GFFT_TARGET("avx512f") V zero() { return wrap(_mm512_setzero_ps()); }
+   static GFFT_TARGET("avx512f") V add(const V a, const V b) { return wrap(_mm512_add_ps(a.r, b.r)); }
+   static GFFT_TARGET("avx512f") V sub(const V a, const V b) { return wrap(_mm512_sub_ps(a.r, b.r)); }
+   template<int Sg>
+   static GFFT_TARGET("avx512f") V addS(const V a, const V b) { return (Sg > 0) ? add(a, b) : sub(a, b); }
+   static GFFT_TARGET("avx512f") V scale(const V a, const float c) { return wrap(_mm512_mul_ps(a.r, _mm512_set1_ps(c))); }
+   static GFFT_TARGET("avx512f") V mul(const V a, const V w)
+   {
+      const R t = _mm512_mul_ps(_mm512_shuffle_ps(a.r, a.r, 0xB1), _mm512_shuffle_ps(w.r, w.r, 0xF5));
+      return wrap(_mm512_fmaddsub_ps(a.r, _mm512_shuffle_ps(w.r, w.r, 0xA0), t));
+   }
+   static GFFT_TARGET("avx512f") V mulmi(const V a) { return wrap(_mm512_mul_ps(_mm512_shuffle_ps(a.r, a.r, 0xB1), set(1, -1).r)); }
+};
+
+
+template<>
+struct SIMDComplex<double,ISA_AVX2>
+{
+   typedef __m256d R;
+   struct V { R r; };
+   static const int Width = 2;
+
+   static GFFT_TARGET("avx2,fma") V wrap(const R a) { V v; v.r = a; return v; }
+   static GFFT_TARGET("avx2,fma") V load(const double* p) { return wrap(_mm256_loadu_pd(p)); }
+   static GFFT_TARGET("avx2,fma") void store(double* p, const V a) { _mm256_storeu_pd(p, a.r); }
+   static GFFT_TARGET("avx2,fma") V set(const double re, const double im) { return wrap(_mm256_setr_pd(re, im, re, im)); }
+   static GFFT_TARGET("avx2,fma") V zero() { return wrap(_mm256_setzero_pd()); }
+   static GFFT_TARGET("avx2,fma") V add(const V a, const V b) { return wrap(_mm256_add_pd(a.r, b.r)); }
+   static GFFT_TARGET("avx2,fma") V sub(const V a, const V b) { return wrap(_mm256_sub_pd(a.r, b.r)); }
+   template<int Sg>
+   static GFFT_TARGET("avx2,fma") V addS(const V a, const V b) { return (Sg > 0) ? add(a, b) : sub(a, b); }
+   static GFFT_TARGET("avx2,fma") V scale(const V a, const double c) { return wrap(_mm256_mul_pd(a.r, _mm256_set1_pd(c))); }
+   static GFFT_TARGET("avx2,fma") V mul(const V a, const V w)
+   {
+      const R t = _mm256_mul_pd(_mm256_permute_pd(a.r, 0x5), _mm256_permute_pd(w.r, 0xF));
+      return wrap(_mm256_fmaddsub_pd(a.r, _mm256_movedup_pd(w.r), t));
+   }
+   static GFFT_TARGET("avx2,fma") V mulmi(const V a)
+   {
+      return wrap(_mm256_xor_pd(_mm256_permute_pd(a.r, 0x5), _mm256_setr_pd(0., -0., 0., -0.)));
+   }
+};
+
+template<>
+struct SIMDComplex<float,ISA_AVX2>
+{
+   typedef __m256 R;
+   struct V { R r; };
+   static const int Width = 4;
+
+   static GFFT_TARGET("avx2,fma") V wrap(const R a) { V v; v.r = a; return v; }
+   static GFFT_TARGET("avx2,fma") V load(const float* p) { return wrap(_mm256_loadu_ps(p)); }
+   static GFFT_TARGET("avx2,fma") void store(float* p, const V a) { _mm256_storeu_ps(p, a.r); }
+   static GFFT_TARGET("avx2,fma") V set(const float re, const float im) { return wrap(_mm256_setr_ps(re, im, re, im, re, im, re, im)); }
+   static GFFT_TARGET("avx2,fma") V zero() { return wrap(_mm256_setzero_ps()); }
+   static GFFT_TARGET("avx2,fma") V add(const V a, const V b) { return wrap(_mm256_add_ps(a.r, b.r)); }
+   static GFFT_TARGET("avx2,fma") V sub(const V a, const V b) { return wrap(_mm256_sub_ps(a.r, b.r)); }
+   template<int Sg>
+   static GFFT_TARGET("avx2,fma") V addS(const V a, const V b) { return (Sg > 0) ? add(a, b) : sub(a, b); }
+   static GFFT_TARGET("avx2,fma") V scale(const V a, const float c) { return wrap(_mm256_mul_ps(a.r, _mm256_set1_ps(c))); }
+   static GFFT_TARGET("avx2,fma") V mul(const V a, const V w)
+   {
+      const R t = _mm256_mul_ps(_mm256_permute_ps(a.r, 0xB1), _mm256_movehdup_ps(w.r));
+      return wrap(_mm256_fmaddsub_ps(a.r, _mm256_moveldup_ps(w.r), t));
+   }
+   static GFFT_TARGET("avx2,fma") V mulmi(const V a)
+   {
+      return wrap(_mm256_xor_ps(_mm256_permute_ps(a.r, 0xB1), _mm256_setr_ps(0.f, -0.f, 0.f, -0.f, 0.f, -0.f, 0.f, -0.f)));
+   }
+};
+
+
+// A single complex double in the SSE2 register is not faster than the scalar code,
+// since the twiddle factors are computed per column, so SIMDComplex<double,ISA_SSE2> is empty
+template<>
+struct SIMDComplex<float,ISA_SSE2>
+{
+   typedef __m128 R;
+   struct V { R r; };
+   static const int Width = 2;
+
+   static GFFT_TARGET("sse2") V wrap(const R a) { V v; v.r = a; return v; }
+   static GFFT_TARGET("sse2") V load(const float* p) { return wrap(_mm_loadu_ps(p)); }
+   static GFFT_TARGET("sse2") void store(float* p, const V a) { _mm_storeu_ps(p, a.r); }
+   static GFFT_TARGET("sse2") V set(const float re, const float im) { return wrap(_mm_setr_ps(re, im, re, im)); }
+   static GFFT_TARGET("sse2") V zero() { return wrap(_mm_setzero_ps()); }
+   static GFFT_TARGET("sse2") V add(const V a, const V b) { return wrap(_mm_add_ps(a.r, b.r)); }
+   static GFFT_TARGET("sse2") V sub(const V a, const V b) { return wrap(_mm_sub_ps(a.r, b.r)); }
+   template<int Sg>
+   static GFFT_TARGET("sse2") V addS(const V a, const V b) { return (Sg > 0) ? add(a, b) : sub(a, b); }
+   static GFFT_TARGET("sse2") V scale(const V a, const float c) { return wrap(_mm_mul_ps(a.r, _mm_set1_ps(c))); }
+   static GFFT_TARGET("sse2") V mul(const V a, const V w)
+   {
+      const R wr = _mm_shuffle_ps(w.r, w.r, _MM_SHUFFLE(2,2,0,0));
+      const R wi = _mm_shuffle_ps(w.r, w.r, _MM_SHUFFLE(3,3,1,1));
+      const R t = _mm_mul_ps(_mm_shuffle_ps(a.r, a.r, _MM_SHUFFLE(2,3,0,1)), wi);
+      // (-t.re, t.im) added
+      return wrap(_mm_add_ps(_mm_mul_ps(a.r, wr), _mm_xor_ps(t, _mm_setr_ps(-0.f, 0.f, -0.f, 0.f))));
+   }
+   static GFFT_TARGET("sse2") V mulmi(const V a)
+   {
+      return wrap(_mm_xor_ps(_mm_shuffle_ps(a.r, a.r, _MM_SHUFFLE(2,3,0,1)), _mm_setr_ps(0.f, -0.f, 0.f, -0.f)));
+   }
+};
+
+#endif
+
+
+/// In-place DFT of the length K of Q::Width columns in the registers
+/*!
+\tparam K length of the DFT: 2, 4, 8, 16 or odd
+\tparam S sign of the transform (-1 for inverse)
+\tparam LT type of the precomputed coefficients
+
+The same computation as DFTk_inp with the complex arithmetic of the pack Q.
+*/
+template<int_t K, int S, typename LT>
+class SIMDButterfly
+{
+   // K is assumed odd
+   static const int_t KH = (K-1)/2;
+   LT m_c[KH], m_s[KH];
+
+public:
+   SIMDButterfly() { ComputeTwiddles<LT, K, S, KH>::apply(m_c, m_s); }
+
+   template<class Q>
+   GFFT_FORCEINLINE void apply(typename Q::V* x) const
+   {
+      typedef typename Q::V U;
+      U s[KH], d[KH];
+      for (int_t i=0; i<KH; ++i) {
+	s[i] = Q::add(x[i+1], x[K-1-i]);
+	d[i] = Q::sub(x[i+1], x[K-1-i]);
+      }
+      const U x0 = x[0];
+      for (int_t i=1; i<KH+1; ++i) {
+	U t1 = Q::zero(), t2 = Q::zero();
+	for (int_t j=0; j<KH; ++j) {
+	  const bool sign_change = (i*(j+1) % K) > KH;
+	  const int_t kk = (i+j*i)%K;
+	  const int_t k = (kk>KH) ? K-kk-1 : kk-1;
+	  t1 = Q::add(t1, Q::scale(s[j], m_c[k]));
+	  t2 = sign_change ? Q::sub(t2, Q::scale(d[j], m_s[k])) : Q::add(t2, Q::scale(d[j], m_s[k]));
+	}
+	const U a = Q::add(x0, t1);
+	const U b = Q::mulmi(t2);
+	x[i]   = Q::add(a, b);
+	x[K-i] = Q::sub(a, b);
+      }
+      U sum = x0;
+      for (int_t i=0; i<KH; ++i)
+	sum = Q::add(sum, s[i]);
+      x[0] = sum;
+   }
+};
+
+template<int S, typename LT>
+class SIMDButterfly<2,S,LT>
+{
+public:
+   template<class Q>
+   GFFT_FORCEINLINE void apply(typename Q::V* x) const
+   {
+      const typename Q::V t = x[1];
+      x[1] = Q::sub(x[0], t);
+      x[0] = Q::add(x[0], t);
+   }
+};
+
+/// In-place DFT(4) of x0, x1, S2*x2, S3*x3
+/** The signs S2 and S3 are the ones of the twiddle factors -1 of the radix-16 step,
+    which are folded into the additions. W = exp(-S*2*pi*i/4) = -S*i.
+*/
+template<int S, int S2, int S3, class Q>
+GFFT_FORCEINLINE void _radix4(typename Q::V& x0, typename Q::V& x1, typename Q::V& x2, typename Q::V& x3)
+{
+   typedef typename Q::V U;
+   const U a0 = Q::template addS<S2>(x0, x2);
+   const U a1 = Q::template addS<-S2>(x0, x2);
+   const U a2 = Q::template addS<S3>(x1, x3);
+   const U b = Q::mulmi(Q::template addS<-S3>(x1, x3));
+   x0 = Q::add(a0, a2);
+   x2 = Q::sub(a0, a2);
+   x1 = Q::template addS<S>(a1, b);
+   x3 = Q::template addS<-S>(a1, b);
+}
+
+// 16 additions, no multiplications
+template<int S, typename LT>
+class SIMDButterfly<4,S,LT>
+{
+public:
+   template<class Q>
+   GFFT_FORCEINLINE void apply(typename Q::V* x) const
+   {
+      _radix4<S,1,1,Q>(x[0], x[1], x[2], x[3]);
+   }
+};
+
+// Two DFT(4) of the even and odd elements and the radix 2 step:
+// 52 additions and 4 multiplications
+template<int S, typename LT>
+class SIMDButterfly<8,S,LT>
+{
+   LT m_r;   // sqrt(1/2)
+
+public:
+   SIMDButterfly() { LT s; ComputeTwiddles<LT, 8, 1, 1>::apply(&m_r, &s); }
+
+   template<class Q>
+   GFFT_FORCEINLINE void apply(typename Q::V* x) const
+   {
+      typedef typename Q::V U;
+      U e[4] = { x[0], x[2], x[4], x[6] };
+      U o[4] = { x[1], x[3], x[5], x[7] };
+      _radix4<S,1,1,Q>(e[0], e[1], e[2], e[3]);
+      _radix4<S,1,1,Q>(o[0], o[1], o[2], o[3]);
+
+      // W^1 = (1 - S*i)/sqrt(2), W^2 = -S*i, W^3 = -(1 + S*i)/sqrt(2)
+      const U o1 = Q::scale(Q::template addS<S>(o[1], Q::mulmi(o[1])), m_r);
+      const U o2 = Q::mulmi(o[2]);
+      const U o3 = Q::scale(Q::template addS<-S>(o[3], Q::mulmi(o[3])), m_r);
+      x[0] = Q::add(e[0], o[0]);
+      x[4] = Q::sub(e[0], o[0]);
+      x[1] = Q::add(e[1], o1);
+      x[5] = Q::sub(e[1], o1);
+      x[2] = Q::template addS<S>(e[2], o2);
+      x[6] = Q::template addS<-S>(e[2], o2);
+      x[3] = Q::sub(e[3], o3);
+      x[7] = Q::add(e[3], o3);
+   }
+};
+
+// Radix-4 steps 4 x 4 with the twiddle factors W^(n*k) between them: 
+// 144 additions and 24 multiplications
+template<int S, typename LT>
+class SIMDButterfly<16,S,LT>
+{
+   LT m_c, m_s, m_r;   // cos(pi/8), sin(pi/8), sqrt(1/2)
+
+   // x *= W^e, W^e = c - S*i*s
+   template<class Q>
+   GFFT_FORCEINLINE void rotate(typename Q::V& x, const LT c, const LT s) const
+   {
+      x = Q::template addS<S>(Q::scale(x, c), Q::scale(Q::mulmi(x), s));
+   }
+
+public:
+   SIMDButterfly() 
+   { 
+      LT c[2], s[2];
+      ComputeTwiddles<LT, 16, 1, 2>::apply(c, s);
+      m_c = c[0];
+      m_s = s[0];
+      m_r = c[1];
+   }
+
+   template<class Q>
+   GFFT_FORCEINLINE void apply(typename Q::V* x) const
+   {
+      // the DFT(4) of x[n], x[n+4], x[n+8], x[n+12] stays in place,
+      // the constant indices keep the elements in the registers
+      _radix4<S,1,1,Q>(x[0], x[4], x[8],  x[12]);
+      _radix4<S,1,1,Q>(x[1], x[5], x[9],  x[13]);
+      _radix4<S,1,1,Q>(x[2], x[6], x[10], x[14]);
+      _radix4<S,1,1,Q>(x[3], x[7], x[11], x[15]);
+
+      // x[n+4*k] *= W^(n*k) without the factors -1, which are the signs of _radix4:
+      // W^2 = (1 - S*i)/sqrt(2), W^4 = -S*i, W^6 = -(1 + S*i)/sqrt(2), W^9 = -W^1
+      rotate<Q>(x[5], m_c, m_s);
+      x[9]  = Q::scale(Q::template addS<S>(x[9], Q::mulmi(x[9])), m_r);
+      rotate<Q>(x[13], m_s, m_c);
+      x[6]  = Q::scale(Q::template addS<S>(x[6], Q::mulmi(x[6])), m_r);
+      x[10] = Q::mulmi(x[10]);
+      x[14] = Q::scale(Q::template addS<-S>(x[14], Q::mulmi(x[14])), m_r);
+      rotate<Q>(x[7], m_s, m_c);
+      x[11] = Q::scale(Q::template addS<-S>(x[11], Q::mulmi(x[11])), m_r);
+      rotate<Q>(x[15], m_c, m_s);
+
+      _radix4<S,1,1,Q>(x[0],  x[1],  x[2],  x[3]);
+      _radix4<S,1,1,Q>(x[4],  x[5],  x[6],  x[7]);
+      _radix4<S,S,-1,Q>(x[8],  x[9],  x[10], x[11]);
+      _radix4<S,-1,-1,Q>(x[12], x[13], x[14], x[15]);
+
+      // X[k+4*m] is at x[m+4*k]
+      std::swap(x[1], x[4]);
+      std::swap(x[2], x[8]);
+      std::swap(x[3], x[12]);
+      std::swap(x[6], x[9]);
+      std::swap(x[7], x[13]);
+      std::swap(x[11], x[14]);
+   }
+};
+
+
+/// Number of the packs of columns, whose twiddle factors are stepped in the value type
+/** The twiddle factors of the first pack are computed from the roots
+    stepped in TempType, so the rounding errors do not accumulate over the whole stage.
+*/
+static const int_t SIMDRootsReseed = 8;
+
+/// Calls the function run() or run_table() of the kernel compiled for the instruction set level ISA
+/** The kernel body is inlined into apply() or table(), which carry the target attribute.
+*/
+template<int ISA>
+struct SIMDTarget {
+   template<class Kernel, typename T>
+   static void apply(const Kernel& k, T* data) { k.run(data); }
+   template<class Kernel, typename T>
+   static void table(const Kernel& k, T* data) { k.run_table(data); }
+};
+
+#ifdef GFFT_SIMD_X86
+template<>
+struct SIMDTarget<ISA_SSE2> {
+   template<class Kernel, typename T>
+   static GFFT_TARGET("sse2") void apply(const Kernel& k, T* data) { k.run(data); }
+   template<class Kernel, typename T>
+   static GFFT_TARGET("sse2") void table(const Kernel& k, T* data) { k.run_table(data); }
+};
+
+template<>
+struct SIMDTarget<ISA_AVX2> {
+   template<class Kernel, typename T>
+   static GFFT_TARGET("avx2,fma") void apply(const Kernel& k, T* data) { k.run(data); }
+   template<class Kernel, typename T>
+   static GFFT_TARGET("avx2,fma") void table(const Kernel& k, T* data) { k.run_table(data); }
+};
+
+template<>
+struct SIMDTarget<ISA_AVX512> {
+   template<class Kernel, typename T>
+   static GFFT_TARGET("avx512f") void apply(const Kernel& k, T* data) { k.run(data); }
+   template<class Kernel, typename T>
+   static GFFT_TARGET("avx512f") void table(const Kernel& k, T* data) { k.run_table(data); }
+};
+#endif
+
+/// Vectorized scaled DFT (DFTk_x_Im_T) for the interleaved data
+/*!
+\tparam K radix: 2, 4, 8, 16 or odd
+\tparam M number of the columns (N=K*M)
+\tparam VType value type with interleaved storage
+\tparam S sign of the transform: 1 - forward, -1 - backward
+\tparam W1 compile-time root of unity
+\tparam Allowed false to use the scalar code
+\tparam ISA instruction set level of SIMDComplex
+
+The Width consecutive columns of SIMDComplex are transformed at once.
+The twiddle factors W1^(k*j) of a pack are multiplied by W1^(k*Width) 
+for the next pack. Every SIMDRootsReseed packs they are recomputed 
+from W1^(k*j0) stepped in TempType and the precomputed W1^(k*l), l=0,...,Width-1.
+The remaining M%Width columns run the same code with ScalarComplex.
+The rows are read in the order of DFTk_inp (KernelInputOrder).
+If TwiddleTables is on, the twiddle factors of every pack are loaded
+from TwiddleTable instead.
+Enabled is false, if there is no vector register for the value type
+or M < Width; then the class must not be used. It is false for K=2
+with TwiddleTables too: the compiler vectorizes the scalar loop
+of the radix 2 over the table as well and it is faster.
+*/
+template<int_t K, int_t M, typename VType, int S, class W1, bool Allowed = true,
+int ISA = GetISA<VType>::value,
+bool isVec = Allowed && (SIMDComplex<typename VType::ValueType,ISA>::Width > 1)
+                     && (M >= SIMDComplex<typename VType::ValueType,ISA>::Width)
+                     && (K != 2 || !TwiddleTables)>
+class DFTk_x_Im_T_simd
+{
+   typedef typename VType::ValueType T;
+public:
+   static const bool Enabled = false;
+   void apply(T*) const { }
+};
+
+template<int_t K, int_t M, typename VType, int S, class W1, bool Allowed, int ISA>
+class DFTk_x_Im_T_simd<K,M,VType,S,W1,Allowed,ISA,true>
+{
+   typedef typename VType::ValueType T;
+   typedef typename VType::TempType LT;
+   typedef SIMDComplex<T,ISA> P;
+   typedef ScalarComplex<T> P1;
+   typedef typename P::V V;
+   typedef typename P1::V V1;
+   static const int_t W = P::Width;
+   static const int_t M2 = 2*M;
+   static const int_t MV = M - M%W;   // columns in the full packs
+   static const int_t JR = W*SIMDRootsReseed;
+
+   typedef KernelInputOrder<K> Order;
+
+   SIMDButterfly<K,S,T> m_bfly;
+   TwiddleTable<K,M,T,S> m_tab;
+   T m_off[2*W*(K-1)];    // W1^(k*l) for k=1,...,K-1, l=0,...,W-1
+   T m_step[2*W*(K-1)];   // W1^(k*W)
+   LT m_wr[K-1], m_wi[K-1];   // W1^(k*JR)
+
+   template<class Q>
+   GFFT_FORCEINLINE void column(T* d, const typename Q::V* tw) const
+   {
+      typename Q::V x[K];
+      x[0] = Q::load(d);
+      GFFT_UNROLL
+      for (int_t e=1; e<K; ++e)
+	x[e] = Q::mul(Q::load(d + Order::value(e)*M2), tw[e-1]);
+      m_bfly.template apply<Q>(x);
+      GFFT_UNROLL
+      for (int_t e=0; e<K; ++e)
+	Q::store(d + e*M2, x[e]);
+   }
+
+public:
+   static const bool Enabled = true;
+
+   DFTk_x_Im_T_simd()
+   {
+      if (TwiddleTables) return;
+      ComputeRoots<K,VType,W1> roots;
+      for (int_t k=0; k<K-1; ++k) {
+	m_off[2*W*k]   = 1;
+	m_off[2*W*k+1] = 0;
+      }
+      for (int_t j=1; j<JR; ++j) {
+	for (int_t k=0; k<K-1; ++k) {
+	  const LT wr = roots.get_real()[k];
+	  const LT wi = roots.get_imag()[k];
+	  if (j < W) {
+	    m_off[2*(W*k+j)]   = wr;
+	    m_off[2*(W*k+j)+1] = wi;
+	  }
+	  else if (j == W)
+	    for (int_t l=0; l<W; ++l) {
+	      m_step[2*(W*k+l)]   = wr;
+	      m_step[2*(W*k+l)+1] = wi;
+	    }
+	}
+	roots.step();
+      }
+      for (int_t k=0; k<K-1; ++k) {
+	m_wr[k] = roots.get_real()[k];
+	m_wi[k] = roots.get_imag()[k];
+      }
+   }
+
+   void apply(T* data) const
+   {
+      if (TwiddleTables)
+	SIMDTarget<ISA>::table(*this, data);
+      else
+	SIMDTarget<ISA>::apply(*this, data);
+   }
+
+   GFFT_FORCEINLINE void run_table(T* data) const
+   {
+      V tw[K-1];
+      for (int_t j=0; j<MV; j+=W) {
+	for (int_t k=0; k<K-1; ++k)
+	  tw[k] = P::load(m_tab.get(k+1) + 2*j);
+	column<P>(data + 2*j, tw);
+      }
+      for (int_t j=MV; j<M; ++j) {
+	V1 tw1[K-1];
+	for (int_t k=0; k<K-1; ++k)
+	  tw1[k] = P1::load(m_tab.get(k+1) + 2*j);
+	column<P1>(data + 2*j, tw1);
+      }
+   }
+
+   GFFT_FORCEINLINE void run(T* data) const
+   {
+      V tw[K-1];
+      LT wr[K-1], wi[K-1], t;   // W1^(k*j0) for j0 = JR, 2*JR, ...
+      for (int_t k=0; k<K-1; ++k) {
+	tw[k] = P::load(m_off + 2*W*k);
+	wr[k] = m_wr[k];
+	wi[k] = m_wi[k];
+      }
+      for (int_t j0=0; ; ) {
+	const int_t je = (j0 + JR < MV) ? j0 + JR : MV;
+	for (int_t j=j0; j<je; j+=W) {
+	  column<P>(data + 2*j, tw);
+	  for (int_t k=0; k<K-1; ++k)
+	    tw[k] = P::mul(tw[k], P::load(m_step + 2*W*k));
+	}
+	if (je == MV) break;
+
+	j0 = je;
+	for (int_t k=0; k<K-1; ++k) {
+	  tw[k] = P::mul(P::load(m_off + 2*W*k), P::set(wr[k], wi[k]));
+	  t = wr[k];
+	  wr[k] = t*m_wr[k] - wi[k]*m_wi[k];
+	  wi[k] = wi[k]*m_wr[k] + t*m_wi[k];
+	}
+      }
+
+      if (MV < M) {
+	// tw are the twiddle factors of the columns MV,...,MV+W-1
+	T rest[2*W*(K-1)];
+	for (int_t k=0; k<K-1; ++k)
+	  P::store(rest + 2*W*k, tw[k]);
+	for (int_t l=0; l<M-MV; ++l) {
+	  V1 tw1[K-1];
+	  for (int_t k=0; k<K-1; ++k)
+	    tw1[k] = P1::load(rest + 2*(W*k+l));
+	  column<P1>(data + 2*(MV+l), tw1);
+	}
+      }
+   }
+};
+
+}  //namespace GFFT
+
+#endif /*__gfftsimd_h*/
@@ -20,6 +20,7 @@
 */
 
 #include "twiddles.h"
+#include "gfftsimd.h"
 #include "Singleton.h"
 
 namespace GFFT {
@@ -33,7 +34,7 @@ namespace GFFT {
 \tparam S sign of the transform (-1 for inverse)
 
 Non-recursive out-of-place DFT for a general (odd) length with 
-short-radix specializations for N=2,3
+short-radix specializations for N=2,3 and N=4,8,16 (see DFTk_pow2)
 */
 template<int_t N, int_t SI, int_t DI, typename VType, int S,
 bool isStd = Loki::TypeTraits<typename VType::ValueType>::isStdFundamental>
@@ -109,7 +110,7 @@ class DFTk<3,SI,DI,VType,S,true>
   static const int_t SI2 = SI+SI;
   static const int_t DI2 = DI+DI;
   static const int Acc = VType::Accuracy;
-  typedef Compute<typename MF::SqrtDecAcc<SInt<3>,Acc>::Result,Acc,T> CSqrt3;
+  typedef Compute<typename MF::SqrtOf<3,Acc>::Result,Acc,T> CSqrt3;
   
   const T m_coef;
   
@@ -187,6 +188,54 @@ public:
   */
 };
 
+/// Out-of-place DFT of the length N = 4, 8, 16
+/*!
+\tparam N length of the data
+\tparam SI step in the source data
+\tparam DI step in the result data
+\tparam T value type
+\tparam S sign of the transform (-1 for inverse)
+
+Both input and output are in natural order (unlike DFTk_inp_pow2).
+The butterfly is SIMDButterfly with the arithmetic of ScalarComplex.
+*/
+template<int_t N, int_t SI, int_t DI, typename VType, int S,
+bool isStd = Loki::TypeTraits<typename VType::ValueType>::isStdFundamental>
+class DFTk_pow2;
+
+template<int_t N, int_t SI, int_t DI, typename VType, int S>
+class DFTk_pow2<N,SI,DI,VType,S,true>
+{
+  typedef typename VType::ValueType T;
+  typedef ScalarComplex<T> Q;
+  typedef typename Q::V V;
+
+  SIMDButterfly<N,S,T> m_bfly;
+
+public:
+  void apply(const T* src, T* dst) 
+  { 
+    // all the input is loaded first, because may happen src == dst
+    V x[N];
+    GFFT_UNROLL
+    for (int_t e=0; e<N; ++e)
+      x[e] = Q::load(src + e*SI);
+    m_bfly.template apply<Q>(x);
+    GFFT_UNROLL
+    for (int_t k=0; k<N; ++k)
+      Q::store(dst + k*DI, x[k]);
+  }
+};
+
+template<int_t SI, int_t DI, typename VType, int S>
+class DFTk<4,SI,DI,VType,S,true> : public DFTk_pow2<4,SI,DI,VType,S> {};
+
+template<int_t SI, int_t DI, typename VType, int S>
+class DFTk<8,SI,DI,VType,S,true> : public DFTk_pow2<8,SI,DI,VType,S> {};
+
+template<int_t SI, int_t DI, typename VType, int S>
+class DFTk<16,SI,DI,VType,S,true> : public DFTk_pow2<16,SI,DI,VType,S> {};
+
 /// Out-of-place specialization for complex-valued radix 2 FFT 
 /// \tparam T is value type
 /// \param data is the array of length 4, containing two complex numbers (real,imag,real,imag).
@@ -310,7 +359,7 @@ class DCT2k<2,SI,DI,VType,S,true>
 {
   typedef typename VType::ValueType T;
   static const int Acc = VType::Accuracy;
-  typedef Compute<typename MF::SqrtDecAcc<SInt<2>,Acc>::Result,Acc,T> CSqrt2;
+  typedef Compute<typename MF::SqrtOf<2,Acc>::Result,Acc,T> CSqrt2;
 
   T m_coef;
 public:
@@ -20,6 +20,7 @@
 */
 
 #include "twiddles.h"
+#include "gfftsimd.h"
 #include "Singleton.h"
 
 namespace GFFT {
@@ -32,7 +33,7 @@ namespace GFFT {
 \tparam S sign of the transform (-1 for inverse)
 
 Non-recursive in-place DFT for a general (odd) length with 
-short-radix specializations for N=2,3
+short-radix specializations for N=2,3 and N=4,8,16 (see DFTk_inp_pow2)
 */
 template<int_t N, int_t M, typename VType, int S,
 bool isStd = Loki::TypeTraits<typename VType::ValueType>::isStdFundamental>
@@ -186,7 +187,7 @@ class DFTk_inp<3,M,VType,S,true>
   
   typedef typename VType::ValueType T;
   static const int Acc = VType::Accuracy;
-  typedef Compute<typename MF::SqrtDecAcc<SInt<3>,Acc>::Result,Acc,T> CSqrt3;
+  typedef Compute<typename MF::SqrtOf<3,Acc>::Result,Acc,T> CSqrt3;
 
   T m_coef;
   
@@ -296,11 +297,11 @@ public:
         data[0] += tr;
         data[1] += ti;
   }
-  // as one above with wr = 0, wi = -1
+  // as one above with wr = 0, wi = -S
   void apply_1(T* data) 
   { 
-        const T tr = data[M+1];
-        const T ti = -data[M];
+        const T tr = S*data[M+1];
+        const T ti = -S*data[M];
         data[M] = data[0]-tr;
         data[M+1] = data[1]-ti;
         data[0] += tr;
@@ -343,6 +344,84 @@ class DFTk_inp<1,M,VType,S,true>
 {
 };
 
+/// In-place DFT of the length N = 4, 8, 16
+/*!
+\tparam N length of the data
+\tparam M step in the data
+\tparam T value type
+\tparam S sign of the transform (-1 for inverse)
+
+The input is in bit-reversed order: the element e is at data[KernelInputOrder<N>::value(e)*M],
+and the output is in natural order. So the kernel computes log2(N) passes of the radix 2 
+on the data reordered by GFFTswap2 at once. The twiddle factors wr[e-1], wi[e-1] belong 
+to the element e. The butterfly is SIMDButterfly with the arithmetic of ScalarComplex.
+\sa GroupPowersOf2
+*/
+template<int_t N, int_t M, typename VType, int S,
+bool isStd = Loki::TypeTraits<typename VType::ValueType>::isStdFundamental>
+class DFTk_inp_pow2;
+
+template<int_t N, int_t M, typename VType, int S>
+class DFTk_inp_pow2<N,M,VType,S,true>
+{
+  typedef typename VType::ValueType T;
+  typedef ScalarComplex<T> Q;
+  typedef typename Q::V V;
+  typedef KernelInputOrder<N> Order;
+
+  SIMDButterfly<N,S,T> m_bfly;
+
+  void _transform(T* data, V* x)
+  {
+    m_bfly.template apply<Q>(x);
+    GFFT_UNROLL
+    for (int_t k=0; k<N; ++k)
+      Q::store(data + k*M, x[k]);
+  }
+
+public:
+  void apply(T* data) 
+  { 
+    V x[N];
+    GFFT_UNROLL
+    for (int_t e=0; e<N; ++e)
+      x[e] = Q::load(data + Order::value(e)*M);
+    _transform(data, x);
+  }
+
+  template<class LT>
+  void apply(T* data, const LT* wr, const LT* wi) 
+  { 
+    V x[N];
+    x[0] = Q::load(data);
+    GFFT_UNROLL
+    for (int_t e=1; e<N; ++e) {
+      const T* d = data + Order::value(e)*M;
+      x[e] = Q::set(d[0]*wr[e-1] - d[1]*wi[e-1], d[0]*wi[e-1] + d[1]*wr[e-1]);
+    }
+    _transform(data, x);
+  }
+
+  template<class LT>
+  void apply_m(T* data, const LT* wr, const LT* wi) 
+  { 
+    const T t = data[0];
+    data[0] = t*wr[0] - data[1]*wi[0];
+    data[1] = t*wi[0] + data[1]*wr[0];
+
+    apply(data, wr+1, wi+1);
+  }
+};
+
+template<int_t M, typename VType, int S>
+class DFTk_inp<4,M,VType,S,true> : public DFTk_inp_pow2<4,M,VType,S> {};
+
+template<int_t M, typename VType, int S>
+class DFTk_inp<8,M,VType,S,true> : public DFTk_inp_pow2<8,M,VType,S> {};
+
+template<int_t M, typename VType, int S>
+class DFTk_inp<16,M,VType,S,true> : public DFTk_inp_pow2<16,M,VType,S> {};
+
 /// In-place specialization for complex-valued radix 2 FFT 
 /// \tparam T is value type
 /// \param data is the array of length 4, containing two complex numbers (real,imag,real,imag).
@@ -0,0 +1,475 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gfftsplit_h
+#define __gfftsplit_h
+
+/** \file
+    \brief FFT of split-complex data (value types SPLIT_DOUBLE, SPLIT_FLOAT)
+
+    The real and imaginary parts are passed as two pointers, so that
+    no interleave/deinterleave pass is needed. The butterflies of every
+    stage run over the contiguous columns of both arrays.
+*/
+
+#include "gfftruntime.h"
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+
+namespace GFFT {
+
+/// Short DFT of the split-complex values xr, xi written into yr, yi with the stride os
+/*!
+\tparam K radix: 2, 3, 4, 5
+\tparam T value type
+\tparam S sign of the transform: 1 - forward, -1 - backward
+*/
+template<int_t K, typename T, int S>
+struct SplitButterfly;
+
+template<typename T, int S>
+struct SplitButterfly<2,T,S>
+{
+   static void apply(const T* xr, const T* xi, T* yr, T* yi, const int_t os)
+   {
+      yr[0]  = xr[0] + xr[1];
+      yi[0]  = xi[0] + xi[1];
+      yr[os] = xr[0] - xr[1];
+      yi[os] = xi[0] - xi[1];
+   }
+};
+
+template<typename T, int S>
+struct SplitButterfly<3,T,S>
+{
+   static void apply(const T* xr, const T* xi, T* yr, T* yi, const int_t os)
+   {
+      const T c = T(-0.5L);
+      const T s = T(S*0.86602540378443864676372317075293618L);
+      const T tr1 = xr[1] + xr[2], ti1 = xi[1] + xi[2];
+      const T tr2 = xr[1] - xr[2], ti2 = xi[1] - xi[2];
+      const T mr = xr[0] + c*tr1, mi = xi[0] + c*ti1;
+      yr[0]    = xr[0] + tr1;
+      yi[0]    = xi[0] + ti1;
+      yr[os]   = mr + s*ti2;
+      yi[os]   = mi - s*tr2;
+      yr[2*os] = mr - s*ti2;
+      yi[2*os] = mi + s*tr2;
+   }
+};
+
+template<typename T, int S>
+struct SplitButterfly<4,T,S>
+{
+   static void apply(const T* xr, const T* xi, T* yr, T* yi, const int_t os)
+   {
+      const T tr0 = xr[0] + xr[2], ti0 = xi[0] + xi[2];
+      const T tr1 = xr[0] - xr[2], ti1 = xi[0] - xi[2];
+      const T tr2 = xr[1] + xr[3], ti2 = xi[1] + xi[3];
+      const T tr3 = xr[1] - xr[3], ti3 = xi[1] - xi[3];
+      yr[0]    = tr0 + tr2;
+      yi[0]    = ti0 + ti2;
+      yr[2*os] = tr0 - tr2;
+      yi[2*os] = ti0 - ti2;
+      yr[os]   = tr1 + S*ti3;
+      yi[os]   = ti1 - S*tr3;
+      yr[3*os] = tr1 - S*ti3;
+      yi[3*os] = ti1 + S*tr3;
+   }
+};
+
+template<typename T, int S>
+struct SplitButterfly<5,T,S>
+{
+   static void apply(const T* xr, const T* xi, T* yr, T* yi, const int_t os)
+   {
+      const T c1 = T(0.30901699437494742410229341718281906L);
+      const T c2 = T(-0.80901699437494742410229341718281906L);
+      const T s1 = T(S*0.95105651629515357211643933337938214L);
+      const T s2 = T(S*0.58778525229247312916870595463907277L);
+      const T tr1 = xr[1] + xr[4], ti1 = xi[1] + xi[4];
+      const T tr2 = xr[2] + xr[3], ti2 = xi[2] + xi[3];
+      const T dr1 = xr[1] - xr[4], di1 = xi[1] - xi[4];
+      const T dr2 = xr[2] - xr[3], di2 = xi[2] - xi[3];
+      const T mr1 = xr[0] + c1*tr1 + c2*tr2, mi1 = xi[0] + c1*ti1 + c2*ti2;
+      const T mr2 = xr[0] + c2*tr1 + c1*tr2, mi2 = xi[0] + c2*ti1 + c1*ti2;
+      const T nr1 = s1*dr1 + s2*dr2, ni1 = s1*di1 + s2*di2;
+      const T nr2 = s2*dr1 - s1*dr2, ni2 = s2*di1 - s1*di2;
+      yr[0]    = xr[0] + tr1 + tr2;
+      yi[0]    = xi[0] + ti1 + ti2;
+      yr[os]   = mr1 + ni1;
+      yi[os]   = mi1 - nr1;
+      yr[4*os] = mr1 - ni1;
+      yi[4*os] = mi1 + nr1;
+      yr[2*os] = mr2 + ni2;
+      yi[2*os] = mi2 - nr2;
+      yr[3*os] = mr2 - ni2;
+      yi[3*os] = mi2 + nr2;
+   }
+};
+
+
+/// Abstract radix of the split-complex runtime algorithm
+/*!
+\tparam T value type of the real and imaginary arrays
+
+leaf() computes DFT of length K reading the input with the stride \a sstride
+and writing the result contiguously.
+stage() performs the scaled DFT(K) x Im with the twiddle factors wr, wi
+for the columns j = jb,...,je-1. The twiddles of the row k=1,...,K-1
+start at the position (k-1)*M, so that they are contiguous in j as the data.
+*/
+template<typename T>
+class SplitRadix
+{
+public:
+   virtual void leaf(const T* sr, const T* si, const int_t sstride, T* dr, T* di) = 0;
+   virtual void stage(T* dr, T* di, const int_t M, const int_t jb, const int_t je,
+                      const T* wr, const T* wi) = 0;
+   virtual ~SplitRadix() {}
+};
+
+/// Split-complex radix using SplitButterfly<K>
+template<int_t K, typename VType, int S>
+class SplitRadixK : public SplitRadix<typename VType::ValueType>
+{
+   typedef typename VType::ValueType T;
+   typedef SplitButterfly<K,T,S> Butterfly;
+
+public:
+   void leaf(const T* sr, const T* si, const int_t sstride, T* dr, T* di)
+   {
+      T xr[K], xi[K];
+      for (int_t k=0; k<K; ++k) {
+	xr[k] = sr[k*sstride];
+	xi[k] = si[k*sstride];
+      }
+      Butterfly::apply(xr, xi, dr, di, 1);
+   }
+
+   void stage(T* dr, T* di, const int_t M, const int_t jb, const int_t je,
+              const T* wr, const T* wi)
+   {
+      for (int_t j=jb; j<je; ++j) {
+	T xr[K], xi[K];
+	xr[0] = dr[j];
+	xi[0] = di[j];
+	for (int_t k=1; k<K; ++k) {
+	  const T ar = dr[k*M+j], ai = di[k*M+j];
+	  const T c = wr[(k-1)*M+j], s = wi[(k-1)*M+j];
+	  xr[k] = ar*c - ai*s;
+	  xi[k] = ar*s + ai*c;
+	}
+	Butterfly::apply(xr, xi, dr + j, di + j, M);
+      }
+   }
+};
+
+/// Split-complex radix for the other primes
+/** The columns are interleaved into a local array and transformed
+    by the runtime radix of the interleaved algorithm (see CreateRuntimeRadix).
+*/
+template<typename VType, int S>
+class SplitRadixGeneric : public SplitRadix<typename VType::ValueType>
+{
+   typedef typename VType::ValueType T;
+   static const int_t StackLimit = 64;
+
+   const int_t m_k;
+   RuntimeRadix<T>* m_radix;
+
+   // disable copying, since the radix is owned
+   SplitRadixGeneric(const SplitRadixGeneric&);
+   SplitRadixGeneric& operator=(const SplitRadixGeneric&);
+
+public:
+   SplitRadixGeneric(const int_t k) : m_k(k), m_radix(CreateRuntimeRadix<VType,S>(k)) { }
+   ~SplitRadixGeneric() { delete m_radix; }
+
+   void leaf(const T* sr, const T* si, const int_t sstride, T* dr, T* di)
+   {
+      // the radices up to StackLimit fit on the stack, the larger ones go to the heap
+      T buf[4*StackLimit];
+      std::vector<T> heap;
+      T* a = (m_k <= StackLimit) ? buf : (heap.resize(4*m_k), &heap[0]);
+      T* b = a + 2*m_k;
+      for (int_t k=0; k<m_k; ++k) {
+	a[2*k]   = sr[k*sstride];
+	a[2*k+1] = si[k*sstride];
+      }
+      m_radix->leaf(a, 2, b, 2);
+      for (int_t k=0; k<m_k; ++k) {
+	dr[k] = b[2*k];
+	di[k] = b[2*k+1];
+      }
+   }
+
+   void stage(T* dr, T* di, const int_t M, const int_t jb, const int_t je,
+              const T* wr, const T* wi)
+   {
+      T buf[4*StackLimit];
+      std::vector<T> heap;
+      T* a = (m_k <= StackLimit) ? buf : (heap.resize(4*m_k), &heap[0]);
+      T* b = a + 2*m_k;
+      for (int_t j=jb; j<je; ++j) {
+	a[0] = dr[j];
+	a[1] = di[j];
+	for (int_t k=1; k<m_k; ++k) {
+	  const T ar = dr[k*M+j], ai = di[k*M+j];
+	  const T c = wr[(k-1)*M+j], s = wi[(k-1)*M+j];
+	  a[2*k]   = ar*c - ai*s;
+	  a[2*k+1] = ar*s + ai*c;
+	}
+	m_radix->leaf(a, 2, b, 2);
+	for (int_t k=0; k<m_k; ++k) {
+	  dr[k*M+j] = b[2*k];
+	  di[k*M+j] = b[2*k+1];
+	}
+      }
+   }
+};
+
+template<typename VType, int S>
+SplitRadix<typename VType::ValueType>* CreateSplitRadix(const int_t k)
+{
+   switch (k) {
+     case 2: return new SplitRadixK<2,VType,S>();
+     case 3: return new SplitRadixK<3,VType,S>();
+     case 4: return new SplitRadixK<4,VType,S>();
+     case 5: return new SplitRadixK<5,VType,S>();
+     default: return new SplitRadixGeneric<VType,S>(k);
+   }
+}
+
+
+/// Out-of-place decimation-in-time FFT of split-complex data
+/*!
+\tparam VType value type: SPLIT_DOUBLE, SPLIT_FLOAT
+\tparam S sign of the transform: 1 - forward, -1 - backward
+
+The same algorithm as RuntimeInTimeOOP, where the real and imaginary
+parts are addressed by two pointers. The factors 2 are paired into
+radix 4. The twiddles are stored row by row, so that the butterflies
+of a stage load contiguous vectors of the data and the twiddles.
+*/
+template<typename VType, int S>
+class RuntimeSplitOOP
+{
+   typedef typename VType::ValueType T;
+
+   struct Stage {
+      int_t K, M;
+      SplitRadix<T>* radix;
+      std::vector<T> wr, wi;
+   };
+
+   const int_t m_n;
+   const int m_nthreads;
+   std::vector<Stage> m_stages;
+
+   void rec(const int_t level, const T* sr, const T* si, const int_t sstride, T* dr, T* di)
+   {
+      Stage& st = m_stages[level];
+      if (st.M == 1) {
+	st.radix->leaf(sr, si, sstride, dr, di);
+	return;
+      }
+      for (int_t k=0; k<st.K; ++k)
+	rec(level+1, sr + k*sstride, si + k*sstride, sstride*st.K, dr + k*st.M, di + k*st.M);
+
+      st.radix->stage(dr, di, st.M, 0, st.M, &st.wr[0], &st.wi[0]);
+   }
+
+   void addStages(const int_t k, const int_t p, int_t& len)
+   {
+      for (int_t i=0; i<p; ++i) {
+	Stage st;
+	st.K = k;
+	st.M = len/k;
+	st.radix = 0;
+	m_stages.push_back(st);
+	len = st.M;
+      }
+   }
+
+   // disable copying, since radices are owned by the stages
+   RuntimeSplitOOP(const RuntimeSplitOOP&);
+   RuntimeSplitOOP& operator=(const RuntimeSplitOOP&);
+
+public:
+   RuntimeSplitOOP(const int_t n, const int nthreads = 1)
+   : m_n(n), m_nthreads(nthreads)
+   {
+      typename RuntimeFactorization<>::FactorList factors;
+      RuntimeFactorization<>::apply(n, factors);
+
+      int_t len = n;
+      for (std::size_t f=0; f<factors.size(); ++f) {
+	const int_t k = factors[f].first, p = factors[f].second;
+	if (k == 2) {
+	  addStages(4, p/2, len);
+	  addStages(2, p%2, len);
+	}
+	else
+	  addStages(k, p, len);
+      }
+
+      for (std::size_t i=0; i<m_stages.size(); ++i) {
+	Stage& st = m_stages[i];
+	st.radix = CreateSplitRadix<VType,S>(st.K);
+	const int_t L = st.K*st.M;
+	st.wr.resize((st.K-1)*st.M);
+	st.wi.resize((st.K-1)*st.M);
+	// each twiddle is computed directly to avoid accumulation of errors
+	for (int_t k=1; k<st.K; ++k)
+	  for (int_t j=0; j<st.M; ++j) {
+	    long double re, im;
+	    direct_root(j*k, L, S, re, im);
+	    st.wr[(k-1)*st.M+j] = re;
+	    st.wi[(k-1)*st.M+j] = im;
+	  }
+      }
+   }
+
+   ~RuntimeSplitOOP()
+   {
+      for (std::size_t i=0; i<m_stages.size(); ++i)
+	delete m_stages[i].radix;
+   }
+
+   int_t length() const { return m_n; }
+
+   void apply(const T* sr, const T* si, T* dr, T* di)
+   {
+      if (m_stages.empty()) {   // n == 1
+	dr[0] = sr[0];
+	di[0] = si[0];
+	return;
+      }
+
+      Stage& st = m_stages[0];
+      if (m_nthreads < 2 || m_n < SwitchToOMP || st.M == 1) {
+	rec(0, sr, si, 1, dr, di);
+	return;
+      }
+
+      #pragma omp parallel num_threads(m_nthreads)
+      {
+	#pragma omp for schedule(static)
+	for (int_t k=0; k<st.K; ++k)
+	  rec(1, sr + k, si + k, st.K, dr + k*st.M, di + k*st.M);
+
+#ifdef _OPENMP
+	const int nt = omp_get_num_threads();
+	const int tid = omp_get_thread_num();
+#else
+	const int nt = 1, tid = 0;
+#endif
+	const int_t jb = st.M*tid/nt;
+	const int_t je = st.M*(tid+1)/nt;
+	st.radix->stage(dr, di, st.M, jb, je, &st.wr[0], &st.wi[0]);
+      }
+   }
+};
+
+
+/// %Transform of split-complex data of a runtime length
+/*!
+\tparam VType value type: SPLIT_DOUBLE, SPLIT_FLOAT
+\tparam Type type of transform: DFT, IDFT
+
+If any of the destination arrays overlaps any of the source ones
+(in place, also with the real and imaginary parts swapped),
+the input is copied into a scratch buffer of the plan first.
+\sa RuntimeSplitOOP, RuntimeSplit
+*/
+template<class VType, class Type>
+class SplitTransform : public AbstractFFT_split<typename VType::ValueType>
+{
+   typedef typename VType::ValueType T;
+
+   RuntimeSplitOOP<VType,Type::Sign> m_plan;
+   ScratchPool<T> m_buf;   // real and imaginary parts of the input
+
+   // whether the arrays of n elements from a and b overlap
+   static bool overlap(const T* a, const T* b, const int_t n)
+   {
+      std::less<const T*> less;
+      return less(a, b + n) && less(b, a + n);
+   }
+
+public:
+   SplitTransform(const int_t n, const int nthreads) : m_plan(n, nthreads), m_buf(2*n) { }
+
+   void fft(const T* src_re, const T* src_im, T* dst_re, T* dst_im)
+   {
+      const int_t n = m_plan.length();
+      if (overlap(src_re, dst_re, n) || overlap(src_re, dst_im, n)
+       || overlap(src_im, dst_re, n) || overlap(src_im, dst_im, n)) {
+	ScratchBuffer<T> buf(m_buf);
+	T* tmp = buf.get();
+	std::copy(src_re, src_re + n, tmp);
+	std::copy(src_im, src_im + n, tmp + n);
+	m_plan.apply(tmp, tmp + n, dst_re, dst_im);
+      }
+      else
+	m_plan.apply(src_re, src_im, dst_re, dst_im);
+
+      if (Type::Sign == -1)
+	for (int_t i=0; i<n; ++i) {
+	  dst_re[i] /= n;
+	  dst_im[i] /= n;
+	}
+   }
+};
+
+
+/// Creates transform objects of split-complex data
+/*!
+\tparam VType value type: SPLIT_DOUBLE, SPLIT_FLOAT
+
+Only one-dimensional complex-valued transforms (DFT, IDFT) are available.
+The number of threads is derived from the parallelization id
+as in OpenMP<NT>::ID = NT-1.
+
+Usage:
+\code
+GFFT::AbstractFFT_split<double>* fft = GFFT::RuntimeSplit<GFFT::SPLIT_DOUBLE>::Create(n, GFFT::DFT::ID);
+fft->fft(re, im, re, im);
+\endcode
+*/
+template<class VType>
+struct RuntimeSplit
+{
+   typedef AbstractFFT_split<typename VType::ValueType> ObjectType;
+
+   static ObjectType* Create(const int_t n, const int_t trans_id, const int_t parall_id = 0)
+   {
+      if (n < 1)
+	return 0;
+      const int nthreads = static_cast<int>(parall_id) + 1;
+      if (trans_id == DFT::ID)
+	return new SplitTransform<VType,DFT>(n, nthreads);
+      if (trans_id == IDFT::ID)
+	return new SplitTransform<VType,IDFT>(n, nthreads);
+      return 0;
+   }
+};
+
+}  //namespace GFFT
+
+#endif /*__gfftsplit_h*/
@@ -52,12 +52,34 @@ class DFTk_x_Im_T<K,LastK,M,Step,VType,S,W1,SimpleSpec,false>
 {
    typedef typename VType::ValueType CT;
    static const int_t N = K*M;
-   DFTk_inp<K,M,VType,S> spec_inp;
+   typedef typename Loki::Select<RaderRadix<K>::value, 
+     DFTk_inp_rader<K,M,VType,S>, DFTk_inp<K,M,VType,S> >::Result Spec;
+   Spec spec_inp;
+   // the storage of CT is interleaved
+   typedef typename InterleavedType<VType>::Result IVType;
+   typedef DFTk_x_Im_T_simd<K,M,IVType,S,W1,(!RaderRadix<K>::value && Step == 1),GetISA<VType>::value> SpecSIMD;
+   SpecSIMD spec_simd;
+   // the vectorized stage has its own table
+   TwiddleTable<K,SimpleSpec,typename IVType::ValueType,S,(TwiddleTables && !SpecSIMD::Enabled)> m_tab;
 public:
    void apply(CT* data) 
    {
+      if (spec_simd.Enabled) {
+	spec_simd.apply(reinterpret_cast<typename IVType::ValueType*>(data));
+	return;
+      }
       spec_inp.apply(data);
 
+      if (TwiddleTables) {
+	CT w[K-1];
+	for (int_t j=1; j<SimpleSpec; ++j) {
+	  for (int_t k=0; k<K-1; ++k)
+	    w[k] = CT(m_tab.get(k+1)[2*j], m_tab.get(k+1)[2*j+1]);
+	  spec_inp.apply(data + j*Step, w);
+	}
+	return;
+      }
+
       ComputeRootsStd<K,VType,W1> roots;
       
       spec_inp.apply(data+Step, roots.get());
@@ -20,6 +20,8 @@
 */
 
 #include "metafunc.h"
+#include "gfftspec_inp.h"
+#include "gfftspec.h"
 
 namespace GFFT {
 
@@ -34,7 +36,7 @@ using namespace MF;
 \tparam S sign of the transform (-1 for inverse)
 
 Non-recursive in-place DFT for a general (odd) length with 
-short-radix specializations for N=2,3
+short-radix specializations for N=2,3 and N=4,8,16 (see DFTk_inp_pow2)
 */
 template<int_t N, int_t M, typename VType, int S>
 class DFTk_inp<N,M,VType,S,false>
@@ -187,6 +189,65 @@ public:
 //   }  
 };
 
+template<int_t N, int_t M, typename VType, int S>
+class DFTk_inp_pow2<N,M,VType,S,false>
+{
+  typedef typename VType::ValueType CT;
+  typedef typename CT::value_type T;
+  typedef ScalarComplex<T> Q;
+  typedef typename Q::V V;
+  typedef KernelInputOrder<N> Order;
+
+  SIMDButterfly<N,S,T> m_bfly;
+
+  void _transform(CT* data, V* x)
+  {
+    m_bfly.template apply<Q>(x);
+    GFFT_UNROLL
+    for (int_t k=0; k<N; ++k)
+      data[k*M] = CT(x[k].re, x[k].im);
+  }
+
+public:
+  void apply(CT* data) 
+  { 
+    V x[N];
+    GFFT_UNROLL
+    for (int_t e=0; e<N; ++e) {
+      const CT& d = data[Order::value(e)*M];
+      x[e] = Q::set(d.real(), d.imag());
+    }
+    _transform(data, x);
+  }
+
+  void apply(CT* data, const CT* w) 
+  { 
+    V x[N];
+    x[0] = Q::set(data[0].real(), data[0].imag());
+    GFFT_UNROLL
+    for (int_t e=1; e<N; ++e) {
+      const CT d(data[Order::value(e)*M]*w[e-1]);
+      x[e] = Q::set(d.real(), d.imag());
+    }
+    _transform(data, x);
+  }
+
+  void apply_m(CT* data, const CT* w) 
+  { 
+    data[0] *= w[0];
+    apply(data, w+1);
+  }
+};
+
+template<int_t M, typename VType, int S>
+class DFTk_inp<4,M,VType,S,false> : public DFTk_inp_pow2<4,M,VType,S> {};
+
+template<int_t M, typename VType, int S>
+class DFTk_inp<8,M,VType,S,false> : public DFTk_inp_pow2<8,M,VType,S> {};
+
+template<int_t M, typename VType, int S>
+class DFTk_inp<16,M,VType,S,false> : public DFTk_inp_pow2<16,M,VType,S> {};
+
 /// Out-of-place DFT for "complex" types like std::complex
 /*!
 \tparam N length of the data
@@ -196,7 +257,7 @@ public:
 \tparam S sign of the transform (-1 for inverse)
 
 Non-recursive out-of-place DFT for a general (odd) length with 
-short-radix specializations for N=2,3
+short-radix specializations for N=2,3 and N=4,8,16 (see DFTk_pow2)
 */
 template<int_t N, int_t SI, int_t DI, typename VType, int S>
 class DFTk<N,SI,DI,VType,S,false>
@@ -292,6 +353,40 @@ public:
   }
 };
 
+template<int_t N, int_t SI, int_t DI, typename VType, int S>
+class DFTk_pow2<N,SI,DI,VType,S,false>
+{
+  typedef typename VType::ValueType CT;
+  typedef typename CT::value_type T;
+  typedef ScalarComplex<T> Q;
+  typedef typename Q::V V;
+
+  SIMDButterfly<N,S,T> m_bfly;
+
+public:
+  void apply(const CT* src, CT* dst) 
+  { 
+    // all the input is loaded first, because may happen src == dst
+    V x[N];
+    GFFT_UNROLL
+    for (int_t e=0; e<N; ++e)
+      x[e] = Q::set(src[e*SI].real(), src[e*SI].imag());
+    m_bfly.template apply<Q>(x);
+    GFFT_UNROLL
+    for (int_t k=0; k<N; ++k)
+      dst[k*DI] = CT(x[k].re, x[k].im);
+  }
+};
+
+template<int_t SI, int_t DI, typename VType, int S>
+class DFTk<4,SI,DI,VType,S,false> : public DFTk_pow2<4,SI,DI,VType,S> {};
+
+template<int_t SI, int_t DI, typename VType, int S>
+class DFTk<8,SI,DI,VType,S,false> : public DFTk_pow2<8,SI,DI,VType,S> {};
+
+template<int_t SI, int_t DI, typename VType, int S>
+class DFTk<16,SI,DI,VType,S,false> : public DFTk_pow2<16,SI,DI,VType,S> {};
+
 /// Specialization for complex-valued radix 2 FFT in-place
 /// \tparam T is value type
 /// \tparam Complex<T> is a generic type representing complex numbers (like std::complex)
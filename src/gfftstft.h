@@ -0,0 +1,281 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gfftstft_h
+#define __gfftstft_h
+
+/** \file
+    \brief Streaming short-time Fourier transform and its inverse
+
+    The frames of a real sample stream are transformed by
+    the real-valued runtime FFT in batches shared by the threads.
+*/
+
+#include "gfftruntime.h"
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+namespace GFFT {
+
+/// Streaming short-time Fourier transform of real samples
+/*!
+\tparam VType value type of the samples: DOUBLE, FLOAT
+
+The samples coming in chunks of any size are kept in a ring buffer
+of n + hop*(batch-1) values. The frame m consists of the samples
+m*hop,...,m*hop+n-1 of the stream and is returned as n/2+1 complex bins.
+As soon as the ring buffer is full or the input is exhausted,
+all the ready frames are transformed as one batch: the frames are distributed
+between the threads, every thread multiplies the frame by the window
+while loading it from the ring buffer into a scratch buffer of the plan and transforms
+it by the single plan RuntimeRealOOP of the length n directly into the output.
+The hop must not exceed n.
+
+Usage:
+\code
+GFFT::STFT<GFFT::DOUBLE> stft(1024, 256, window, GFFT::OpenMP<4>::ID);
+GFFT::int_t nf = stft.frames(len);   // frames of the next len samples
+std::vector<double> bins(2*nf*stft.bins());
+stft.process(x, len, &bins[0]);
+\endcode
+\sa ISTFT
+*/
+template<class VType>
+class STFT
+{
+   typedef typename VType::ValueType T;
+   typedef typename InterleavedType<VType>::Result IVType;
+   typedef typename IVType::ValueType BT;
+
+   const int_t m_n, m_hop, m_batch, m_cap;
+   const int m_nthreads;
+   RuntimeRealOOP<IVType,1> m_plan;
+   std::vector<BT> m_window;
+   std::vector<BT> m_ring;
+   int_t m_start, m_count;   // position of the oldest sample and number of samples in m_ring
+   ScratchPool<BT> m_buf;    // a windowed frame for every thread
+
+   // nf frames from the ring buffer into dst
+   void transform(const int_t nf, BT* dst)
+   {
+      const int_t nb2 = 2*bins();
+      #pragma omp parallel num_threads(m_nthreads) if(m_nthreads > 1 && nf > 1)
+      {
+	// each thread borrows its own frame buffer from the pool of the plan
+	ScratchBuffer<BT> buf(m_buf);
+	#pragma omp for schedule(static)
+	for (int_t f=0; f<nf; ++f) {
+	  const int_t p = (m_start + f*m_hop) % m_cap;
+	  const int_t n1 = std::min(m_n, m_cap - p);
+	  for (int_t i=0; i<n1; ++i)
+	    buf[i] = m_ring[p+i]*m_window[i];
+	  for (int_t i=n1; i<m_n; ++i)
+	    buf[i] = m_ring[i-n1]*m_window[i];
+	  m_plan.apply(buf.get(), dst + f*nb2);
+	}
+      }
+   }
+
+public:
+   /// Plans the frames of the length n
+   /** \param window n values or 0 for the rectangular window
+       \param parall_id parallelization id of the threads, which share the frames
+                        (OpenMP<NT>::ID = NT-1); the transforms are serial
+       \param batch maximal number of frames in a batch or 0 for 4 per thread
+   */
+   STFT(const int_t n, const int_t hop, const T* window = 0,
+        const int_t parall_id = 0, const int_t batch = 0)
+   : m_n(n), m_hop(hop), m_batch(batch ? batch : 4*(parall_id+1)),
+     m_cap(n + hop*(m_batch-1)), m_nthreads(static_cast<int>(parall_id) + 1),
+     m_plan(n, 1), m_window(n, BT(1)), m_ring(m_cap), m_start(0), m_count(0), m_buf(n)
+   {
+      if (window)
+	std::copy(reinterpret_cast<const BT*>(window), reinterpret_cast<const BT*>(window) + n, m_window.begin());
+   }
+
+   /// Frame length
+   int_t length() const { return m_n; }
+
+   /// Number of the complex bins of a frame
+   int_t bins() const { return m_n/2 + 1; }
+
+   /// Number of the frames, which are completed by the next len samples
+   int_t frames(const int_t len) const
+   {
+      const int_t total = m_count + len;
+      return (total < m_n) ? 0 : (total - m_n)/m_hop + 1;
+   }
+
+   /// Appends len samples to the stream and returns the completed frames
+   /** \param dst frames(len) frames of bins() complex values
+       \return number of the frames written into dst
+   */
+   int_t process(const T* x, int_t len, T* dst)
+   {
+      const BT* xb = reinterpret_cast<const BT*>(x);
+      BT* d = reinterpret_cast<BT*>(dst);
+      int_t total = 0;
+      while (len > 0) {
+	const int_t c = std::min(len, m_cap - m_count);
+	const int_t p = (m_start + m_count) % m_cap;
+	const int_t c1 = std::min(c, m_cap - p);
+	std::copy(xb, xb + c1, m_ring.begin() + p);
+	std::copy(xb + c1, xb + c, m_ring.begin());
+	m_count += c;
+	xb += c;
+	len -= c;
+
+	if (m_count < m_n) break;
+	const int_t nf = (m_count - m_n)/m_hop + 1;
+	transform(nf, d);
+	d += 2*nf*bins();
+	total += nf;
+	m_start = (m_start + nf*m_hop) % m_cap;
+	m_count -= nf*m_hop;
+      }
+      return total;
+   }
+
+   /// Starts a new stream
+   void reset() { m_start = m_count = 0; }
+};
+
+
+/// Streaming inverse short-time Fourier transform by overlap-add
+/*!
+\tparam VType value type of the samples: DOUBLE, FLOAT
+
+Every frame of n/2+1 complex bins is transformed back by
+the single plan RuntimeRealOOP of the length n, multiplied by the
+synthesis window and added to the accumulator at the position m*hop.
+The squared window is accumulated in the same way, so that the output
+is divided by the sum of the squared windows at every sample.
+This reconstructs the input of STFT with the same window and hop exactly
+wherever the sum is not zero, also at the beginning of the stream.
+The inverse transforms of a batch are distributed between the threads,
+the overlap-add runs sequentially.
+
+Every frame completes hop output samples, flush() returns the last n-hop samples.
+\sa STFT
+*/
+template<class VType>
+class ISTFT
+{
+   typedef typename VType::ValueType T;
+   typedef typename InterleavedType<VType>::Result IVType;
+   typedef typename IVType::ValueType BT;
+
+   const int_t m_n, m_hop, m_batch;
+   const int m_nthreads;
+   RuntimeRealOOP<IVType,-1> m_plan;
+   std::vector<BT> m_window;   // synthesis window scaled by 1/n
+   std::vector<BT> m_wsq;      // squared window
+   std::vector<BT> m_acc, m_norm, m_work;
+   int_t m_pos;                // position of the next output sample in m_acc
+
+   // hop samples from the position m_pos into y
+   void emit(BT* y, const int_t len)
+   {
+      const BT eps = std::numeric_limits<BT>::epsilon();
+      for (int_t i=0; i<len; ++i) {
+	const int_t k = (m_pos + i) % m_n;
+	y[i] = (m_norm[k] > eps) ? m_acc[k]/m_norm[k] : BT(0);
+	m_acc[k] = m_norm[k] = 0;
+      }
+      m_pos = (m_pos + len) % m_n;
+   }
+
+public:
+   /// Plans the frames of the length n
+   /** \param window n values or 0 for the rectangular window
+       \param parall_id parallelization id of the threads, which share the frames
+                        (OpenMP<NT>::ID = NT-1); the transforms are serial
+       \param batch maximal number of frames in a batch or 0 for 4 per thread
+   */
+   ISTFT(const int_t n, const int_t hop, const T* window = 0,
+         const int_t parall_id = 0, const int_t batch = 0)
+   : m_n(n), m_hop(hop), m_batch(batch ? batch : 4*(parall_id+1)),
+     m_nthreads(static_cast<int>(parall_id) + 1),
+     m_plan(n, 1), m_window(n, BT(1)/n), m_wsq(n, BT(1)),
+     m_acc(n, BT(0)), m_norm(n, BT(0)), m_work(m_batch*n), m_pos(0)
+   {
+      if (window) {
+	const BT* w = reinterpret_cast<const BT*>(window);
+	for (int_t i=0; i<n; ++i) {
+	  m_window[i] = w[i]/n;
+	  m_wsq[i] = w[i]*w[i];
+	}
+      }
+   }
+
+   /// Frame length
+   int_t length() const { return m_n; }
+
+   /// Number of the complex bins of a frame
+   int_t bins() const { return m_n/2 + 1; }
+
+   /// Appends nf frames of bins() complex values and returns nf*hop completed samples
+   void process(const T* frames, const int_t nf, T* y)
+   {
+      const BT* src = reinterpret_cast<const BT*>(frames);
+      BT* yb = reinterpret_cast<BT*>(y);
+      const int_t nb2 = 2*bins();
+      for (int_t f0=0; f0<nf; f0+=m_batch) {
+	const int_t nb = std::min(m_batch, nf - f0);
+	#pragma omp parallel for schedule(static) num_threads(m_nthreads) if(m_nthreads > 1 && nb > 1)
+	for (int_t f=0; f<nb; ++f) {
+	  BT* w = &m_work[f*m_n];
+	  m_plan.apply(src + (f0+f)*nb2, w);
+	  for (int_t i=0; i<m_n; ++i)
+	    w[i] *= m_window[i];
+	}
+
+	for (int_t f=0; f<nb; ++f) {
+	  const BT* w = &m_work[f*m_n];
+	  const int_t n1 = m_n - m_pos;
+	  for (int_t i=0; i<n1; ++i) {
+	    m_acc[m_pos+i] += w[i];
+	    m_norm[m_pos+i] += m_wsq[i];
+	  }
+	  for (int_t i=n1; i<m_n; ++i) {
+	    m_acc[i-n1] += w[i];
+	    m_norm[i-n1] += m_wsq[i];
+	  }
+	  emit(yb, m_hop);
+	  yb += m_hop;
+	}
+      }
+   }
+
+   /// Returns the last n-hop samples of the stream and resets it
+   void flush(T* y)
+   {
+      emit(reinterpret_cast<BT*>(y), m_n - m_hop);
+      reset();
+   }
+
+   /// Starts a new stream
+   void reset()
+   {
+      std::fill(m_acc.begin(), m_acc.end(), BT(0));
+      std::fill(m_norm.begin(), m_norm.end(), BT(0));
+      m_pos = 0;
+   }
+};
+
+}  //namespace GFFT
+
+#endif /*__gfftstft_h*/
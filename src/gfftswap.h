@@ -252,7 +252,7 @@ public:
       wpi = -S*Sin<N,1,LocalVType>::value();
       wr = 1.+wpr;
       wi = wpi;
-      for (i=1; i<N/2; ++i) {
+      for (i=1; i<(N+1)/2; ++i) {
         i1 = i+i;
         i2 = i1+1;
         i3 = 2*N-i1;
@@ -276,13 +276,31 @@ public:
       data[0] = M*0.5*(h1r + data[1]);
       data[1] = M*0.5*(h1r - data[1]);
 
-      if (N>1) data[N+1] = -data[N+1];
+      // the middle bin of even N is not paired
+      if (N>1 && N%2 == 0) data[N+1] = -data[N+1];
    }
    
-   void apply(const T*, T*) 
+   /// Out-of-place version with N+1 complex output (forward) or input (backward) bins
+   /** The forward transform separates the result of the complex transform
+       in dst and moves the Nyquist term from dst[1] to the bin N.
+       The backward transform packs the bin N of src into dst[1]
+       and prepares dst for the complex transform.
+   */
+   void apply(const T* src, T* dst) 
    { 
-      std::cout << "Not implemented!" << std::endl;
-      exit(1);
+      if (S == 1) {
+	apply(dst);
+	dst[2*N] = dst[1];
+	dst[2*N+1] = 0;
+	dst[1] = 0;
+      }
+      else {
+	if (src != dst)
+	  for (int_t i=2; i<2*N; ++i) dst[i] = src[i];
+	dst[0] = src[0];
+	dst[1] = src[2*N];
+	apply(dst);
+      }
    }
 };
 
@@ -309,7 +327,7 @@ public:
       LocalComplex wp(-2.*wtemp*wtemp,-S*Sin<N,1,LocalVType>::value());
       LocalComplex w(1.+wp.real(),wp.imag());
 
-      for (i=1; i<N/2; ++i) {
+      for (i=1; i<(N+1)/2; ++i) {
         i1 = N-i;
         h1 = LocalComplex(static_cast<LocalVType>(0.5*(data[i].real()+data[i1].real())),
                           static_cast<LocalVType>(0.5*(data[i].imag()-data[i1].imag())));
@@ -325,13 +343,24 @@ public:
       wtemp = data[0].real();
       data[0] = CT(M*0.5*(wtemp + data[0].imag()), M*0.5*(wtemp - data[0].imag()));
 
-      data[N/2] = CT(data[N/2].real(), -data[N/2].imag());
+      if (N%2 == 0)
+        data[N/2] = CT(data[N/2].real(), -data[N/2].imag());
    }
 
-   void apply(const CT*, CT*) 
+   /// Out-of-place version with N+1 complex output (forward) or input (backward) bins
+   void apply(const CT* src, CT* dst) 
    { 
-      std::cout << "Not implemented!" << std::endl;
-      exit(1);
+      if (S == 1) {
+	apply(dst);
+	dst[N] = CT(dst[0].imag(), 0);
+	dst[0] = CT(dst[0].real(), 0);
+      }
+      else {
+	if (src != dst)
+	  for (int_t i=1; i<N; ++i) dst[i] = src[i];
+	dst[0] = CT(src[0].real(), src[N].real());
+	apply(dst);
+      }
    }
 };
 
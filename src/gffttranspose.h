@@ -0,0 +1,332 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gffttranspose_h
+#define __gffttranspose_h
+
+/** \file
+    \brief Transpose of complex matrices
+*/
+
+#include "sint.h"
+#include "gfftpolicy.h"
+
+#include <vector>
+#include <complex>
+#include <algorithm>
+
+namespace GFFT {
+
+/// Edge of the square tiles, which are distributed between the threads
+static const int_t TransposeTile = 64;
+
+/// Edge of the blocks, where the recursive subdivision stops
+static const int_t TransposeLeaf = 16;
+
+
+/// Transpose of a complex matrix in row-major order
+/*!
+\tparam VType value type: DOUBLE, FLOAT (interleaved storage), COMPLEX_DOUBLE, COMPLEX_FLOAT
+\tparam Parall parallelization: Serial or OpenMP<NT>
+
+The matrix is split into tiles of TransposeTile x TransposeTile elements,
+which are distributed between the threads. Every tile is transposed
+by the cache-oblivious recursive subdivision of the longer side
+down to the blocks of TransposeLeaf x TransposeLeaf elements.
+The square matrices are transposed in-place by swapping the pairs of tiles
+across the diagonal. If one side of a rectangular matrix is a multiple
+of the other one, the matrix is a column or a row of squares. They are
+transposed in-place as above, and the rows of the squares are moved
+as contiguous segments. Otherwise the in-place transpose is decomposed
+into the permutations inside the rows and the columns, which are
+distributed between the threads; every thread needs a buffer of
+max(cols, TransposeTile^2) elements.
+The sizes and leading dimensions are counted in complex elements.
+*/
+template<class VType, class Parall = Serial>
+struct Transpose
+{
+   typedef typename VType::ValueType T;
+   // the interleaved storage is layout compatible with std::complex
+   typedef std::complex<typename VType::base_type> E;
+
+   static const int NThreads = Parall::NParProc;
+
+private:
+   // dst[j*ldd+i] = src[i*lds+j] for i0<=i<i1, j0<=j<j1
+   static void rec(const E* src, const int_t lds, E* dst, const int_t ldd,
+                   const int_t i0, const int_t i1, const int_t j0, const int_t j1)
+   {
+      const int_t di = i1 - i0, dj = j1 - j0;
+      if (di <= TransposeLeaf && dj <= TransposeLeaf) {
+	for (int_t i=i0; i<i1; ++i)
+	  for (int_t j=j0; j<j1; ++j)
+	    dst[j*ldd+i] = src[i*lds+j];
+      }
+      else if (di >= dj) {
+	const int_t im = i0 + di/2;
+	rec(src, lds, dst, ldd, i0, im, j0, j1);
+	rec(src, lds, dst, ldd, im, i1, j0, j1);
+      }
+      else {
+	const int_t jm = j0 + dj/2;
+	rec(src, lds, dst, ldd, i0, i1, j0, jm);
+	rec(src, lds, dst, ldd, i0, i1, jm, j1);
+      }
+   }
+
+   // swaps a[i*n+j] and a[j*n+i] for i0<=i<i1, j0<=j<j1,
+   // where the block lies above the diagonal (i < j)
+   static void recSwap(E* a, const int_t n,
+                       const int_t i0, const int_t i1, const int_t j0, const int_t j1)
+   {
+      const int_t di = i1 - i0, dj = j1 - j0;
+      if (di <= TransposeLeaf && dj <= TransposeLeaf) {
+	for (int_t i=i0; i<i1; ++i)
+	  for (int_t j=j0; j<j1; ++j)
+	    std::swap(a[i*n+j], a[j*n+i]);
+      }
+      else if (di >= dj) {
+	const int_t im = i0 + di/2;
+	recSwap(a, n, i0, im, j0, j1);
+	recSwap(a, n, im, i1, j0, j1);
+      }
+      else {
+	const int_t jm = j0 + dj/2;
+	recSwap(a, n, i0, i1, j0, jm);
+	recSwap(a, n, i0, i1, jm, j1);
+      }
+   }
+
+   // transposes the diagonal block [b0,b1) x [b0,b1) in-place
+   static void recDiag(E* a, const int_t n, const int_t b0, const int_t b1)
+   {
+      const int_t d = b1 - b0;
+      if (d <= TransposeLeaf) {
+	for (int_t i=b0; i<b1; ++i)
+	  for (int_t j=i+1; j<b1; ++j)
+	    std::swap(a[i*n+j], a[j*n+i]);
+	return;
+      }
+      const int_t bm = b0 + d/2;
+      recDiag(a, n, b0, bm);
+      recDiag(a, n, bm, b1);
+      recSwap(a, n, b0, bm, bm, b1);
+   }
+
+   static void square(E* a, const int_t n)
+   {
+      const int_t nt = (n + TransposeTile - 1)/TransposeTile;
+      #pragma omp parallel for schedule(dynamic) num_threads(NThreads) if(NThreads > 1 && nt > 1)
+      for (int_t ti=0; ti<nt; ++ti) {
+	const int_t i0 = ti*TransposeTile;
+	const int_t i1 = std::min(i0 + TransposeTile, n);
+	recDiag(a, n, i0, i1);
+	for (int_t tj=ti+1; tj<nt; ++tj) {
+	  const int_t j0 = tj*TransposeTile;
+	  recSwap(a, n, i0, i1, j0, std::min(j0 + TransposeTile, n));
+	}
+      }
+   }
+
+   // permutes the rows x cols matrix of the segments of len elements
+   // into the cols x rows matrix following the cycles of the permutation,
+   // where the segment k moves to the position k*rows mod (rows*cols-1);
+   // every thread moves its own piece of all segments
+   static void segments(E* a, const int_t rows, const int_t cols, const int_t len)
+   {
+      const int_t n1 = rows*cols - 1;
+      std::vector<int_t> leaders;
+      {
+	std::vector<bool> visited(n1 + 1, false);
+	for (int_t s=1; s<n1; ++s) {
+	  if (visited[s]) continue;
+	  leaders.push_back(s);
+	  int_t k = s;
+	  do {
+	    k = (k*rows) % n1;
+	    visited[k] = true;
+	  } while (k != s);
+	}
+      }
+      const int_t nl = static_cast<int_t>(leaders.size());
+      const int_t ps = (len + NThreads - 1)/NThreads;
+      const int_t np = (len + ps - 1)/ps;
+      #pragma omp parallel num_threads(NThreads) if(NThreads > 1 && np > 1)
+      {
+	// every thread moves its piece of ps elements of the rows through t
+	std::vector<E> buf(ps);
+	E* t = &buf[0];
+	#pragma omp for schedule(static)
+	for (int_t p=0; p<np; ++p) {
+	  const int_t p0 = p*ps, pl = std::min(ps, len - p0);
+	  for (int_t l=0; l<nl; ++l) {
+	    const int_t s = leaders[l];
+	    std::copy(a + s*len + p0, a + s*len + p0 + pl, t);
+	    int_t k = s;
+	    do {
+	      k = (k*rows) % n1;
+	      std::swap_ranges(t, t + pl, a + k*len + p0);
+	    } while (k != s);
+	  }
+	}
+      }
+   }
+
+   static int_t gcd(int_t a, int_t b)
+   {
+      while (b) {
+	const int_t t = a % b;
+	a = b;
+	b = t;
+      }
+      return a;
+   }
+
+   // The transpose of the m x n matrix is decomposed into three permutations:
+   // inside the columns, inside the rows and inside the columns again
+   // (B. Catanzaro, A. Keller, M. Garland, A decomposition for in-place
+   // matrix transposition, PPoPP 2014). With c = gcd(m,n) and b = n/c,
+   // the element A(i,j) is moved
+   // 1. to the row (i - j/b) mod m, if c > 1,
+   // 2. to the column (j*m + i) mod n and
+   // 3. to the row (j*m + i)/n.
+   // The columns are permuted by blocks of w columns through a buffer of m x w.
+   static void rectangular(E* a, const int_t m, const int_t n)
+   {
+      const int_t b = n/gcd(m, n);
+      const int_t w = std::max<int_t>(1, std::min<int_t>(TransposeLeaf, TransposeTile*TransposeTile/m));
+      const int_t nb = (n + w - 1)/w;
+      #pragma omp parallel num_threads(NThreads) if(NThreads > 1)
+      {
+	// a block of m x w or a row of n elements for every thread
+	std::vector<E> buf(std::max(n, m*w));
+	E* t = &buf[0];
+
+	if (b < n) {
+	  #pragma omp for schedule(static)
+	  for (int_t blk=0; blk<nb; ++blk) {
+	    const int_t j0 = blk*w, nc = std::min(w, n - j0);
+	    for (int_t i=0; i<m; ++i)
+	      for (int_t c=0; c<nc; ++c) {
+		int_t k = i + (j0 + c)/b;
+		if (k >= m) k -= m;
+		t[i*nc + c] = a[k*n + j0 + c];
+	      }
+	    for (int_t i=0; i<m; ++i)
+	      std::copy(t + i*nc, t + (i+1)*nc, a + i*n + j0);
+	  }
+	}
+
+	const int_t mn = m % n;
+	#pragma omp for schedule(static)
+	for (int_t i=0; i<m; ++i) {
+	  E* r = a + i*n;
+	  int_t jm = 0;            // j*m mod n
+	  for (int_t q=0; q*b<n; ++q) {
+	    int_t k = i + q;       // the row of the element before step 1
+	    if (k >= m) k -= m;
+	    k %= n;
+	    for (int_t j=q*b; j<(q+1)*b; ++j) {
+	      int_t d = jm + k;
+	      if (d >= n) d -= n;
+	      t[d] = r[j];
+	      jm += mn;
+	      if (jm >= n) jm -= n;
+	    }
+	  }
+	  std::copy(t, t + n, r);
+	}
+
+	#pragma omp for schedule(static)
+	for (int_t blk=0; blk<nb; ++blk) {
+	  const int_t j0 = blk*w, nc = std::min(w, n - j0);
+	  for (int_t r=0; r<m; ++r) {
+	    // the element at p = r*n + s is A(p mod m, p/m)
+	    const int_t p = r*n + j0;
+	    int_t i = p % m, j = p/m;
+	    int_t q = j/b, jb = j - q*b;
+	    for (int_t c=0; c<nc; ++c) {
+	      int_t k = i - q;
+	      if (k < 0) k += m;
+	      t[r*nc + c] = a[k*n + j0 + c];
+	      if (++i == m) {
+		i = 0;
+		if (++jb == b) {
+		  jb = 0;
+		  ++q;
+		}
+	      }
+	    }
+	  }
+	  for (int_t r=0; r<m; ++r)
+	    std::copy(t + r*nc, t + (r+1)*nc, a + r*n + j0);
+	}
+      }
+   }
+
+public:
+   /// Out-of-place transpose of the rows x cols matrix src into the cols x rows matrix dst
+   /** \param lds, ldd leading dimensions (row lengths) of src and dst
+   */
+   static void apply(const T* src, T* dst, const int_t rows, const int_t cols,
+                     const int_t lds, const int_t ldd)
+   {
+      const E* s = reinterpret_cast<const E*>(src);
+      E* d = reinterpret_cast<E*>(dst);
+      const int_t nti = (rows + TransposeTile - 1)/TransposeTile;
+      const int_t ntj = (cols + TransposeTile - 1)/TransposeTile;
+      #pragma omp parallel for schedule(static) num_threads(NThreads) if(NThreads > 1 && nti*ntj > 1)
+      for (int_t t=0; t<nti*ntj; ++t) {
+	const int_t i0 = (t/ntj)*TransposeTile;
+	const int_t j0 = (t%ntj)*TransposeTile;
+	rec(s, lds, d, ldd, i0, std::min(i0 + TransposeTile, rows),
+	                    j0, std::min(j0 + TransposeTile, cols));
+      }
+   }
+
+   static void apply(const T* src, T* dst, const int_t rows, const int_t cols)
+   {
+      apply(src, dst, rows, cols, cols, rows);
+   }
+
+   /// In-place transpose of the rows x cols matrix into the cols x rows matrix
+   static void apply(T* data, const int_t rows, const int_t cols)
+   {
+      E* a = reinterpret_cast<E*>(data);
+      if (rows == cols)
+	square(a, rows);
+      else if (rows == 1 || cols == 1)
+	return;
+      else if (rows % cols == 0) {
+	// the column of squares is transposed into the row of squares
+	const int_t k = rows/cols;
+	for (int_t q=0; q<k; ++q)
+	  square(a + q*cols*cols, cols);
+	segments(a, k, cols, cols);
+      }
+      else if (cols % rows == 0) {
+	const int_t k = cols/rows;
+	segments(a, rows, k, rows);
+	for (int_t q=0; q<k; ++q)
+	  square(a + q*rows*rows, rows);
+      }
+      else
+	rectangular(a, rows, cols);
+   }
+};
+
+}  //namespace GFFT
+
+#endif /*__gffttranspose_h*/
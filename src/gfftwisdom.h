@@ -0,0 +1,300 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __gfftwisdom_h
+#define __gfftwisdom_h
+
+/** \file
+    \brief Storage of the measured plan variants (wisdom)
+*/
+
+#include "sint.h"
+#include "gfftcache.h"
+#include "gfftcpu.h"
+
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define GFFT_WISDOM_MMAP
+#endif
+
+namespace GFFT {
+
+/// Record of the wisdom file
+/** All fields are stored in the native byte order.
+*/
+struct WisdomRecord
+{
+   uint32_t cpu;
+   uint8_t  vtype_id, trans_id, dim, parall_id, place_id;
+   uint8_t  variant_id;
+   uint8_t  reserved[2];
+   int64_t  n;        // 64-bit like int_t, the record has no padding
+
+   WisdomRecord() { }
+
+   WisdomRecord(const uint32_t cpu_, const PlanKey& k, const id_t variant)
+   : cpu(cpu_),
+     vtype_id(static_cast<uint8_t>(k.vtype_id)), trans_id(static_cast<uint8_t>(k.trans_id)),
+     dim(static_cast<uint8_t>(k.dim)), parall_id(static_cast<uint8_t>(k.parall_id)),
+     place_id(static_cast<uint8_t>(k.place_id)), variant_id(static_cast<uint8_t>(variant)),
+     n(static_cast<int64_t>(k.n))
+   {
+      reserved[0] = reserved[1] = 0;
+   }
+
+   bool operator<(const WisdomRecord& r) const
+   {
+      if (cpu != r.cpu) return cpu < r.cpu;
+      if (n != r.n) return n < r.n;
+      if (vtype_id != r.vtype_id) return vtype_id < r.vtype_id;
+      if (trans_id != r.trans_id) return trans_id < r.trans_id;
+      if (dim != r.dim) return dim < r.dim;
+      if (parall_id != r.parall_id) return parall_id < r.parall_id;
+      return place_id < r.place_id;
+   }
+
+   bool sameKey(const WisdomRecord& r) const
+   {
+      return !(*this < r) && !(r < *this);
+   }
+};
+
+/// Header of the wisdom file followed by the records sorted by key
+struct WisdomHeader
+{
+   char     magic[4];
+   uint32_t version;
+   uint32_t record_size;
+   uint32_t count;
+};
+
+static const char WisdomMagic[4] = { 'G', 'F', 'F', 'W' };
+static const uint32_t WisdomVersion = 1;
+
+
+/// Plan variants selected by measurement
+/*!
+Maps the transform parameters and the processor signature onto PlanVariant::ID
+of the fastest variant. The variants measured in this process are kept in memory.
+The variants measured before are read from a wisdom file by import_from(),
+which maps the file into memory, so that no parsing is needed at startup.
+The lookup of a mapped record is a binary search.
+The records of other processors are kept in the file, but never used.
+
+The functions may be called from several threads concurrently,
+except import_from(), which is meant to be called at the start of the process.
+\sa GenerateTransform, cpu_signature
+*/
+class PlanWisdom
+{
+   typedef std::map<PlanKey,id_t> MapType;
+   MapType m_map;
+
+   const uint32_t m_cpu;
+   const WisdomRecord* m_rec;
+   uint_t m_nrec;
+
+   std::vector<WisdomRecord> m_buf;
+   void* m_mapped;
+   size_t m_mapped_len;
+
+   void release()
+   {
+#ifdef GFFT_WISDOM_MMAP
+      if (m_mapped)
+	munmap(m_mapped, m_mapped_len);
+#endif
+      m_mapped = 0;
+      m_mapped_len = 0;
+      m_buf.clear();
+      m_rec = 0;
+      m_nrec = 0;
+   }
+
+   static bool valid(const WisdomHeader& h, const size_t len)
+   {
+      return std::memcmp(h.magic, WisdomMagic, 4) == 0
+          && h.version == WisdomVersion
+          && h.record_size == sizeof(WisdomRecord)
+          && len == sizeof(WisdomHeader) + h.count*sizeof(WisdomRecord);
+   }
+
+   int_t findMapped(const PlanKey& key) const
+   {
+      const WisdomRecord r(m_cpu, key, 0);
+      const WisdomRecord* p = std::lower_bound(m_rec, m_rec + m_nrec, r);
+      if (p != m_rec + m_nrec && p->sameKey(r))
+	return p->variant_id;
+      return -1;
+   }
+
+   // disable copying, since the file mapping is owned
+   PlanWisdom(const PlanWisdom&);
+   PlanWisdom& operator=(const PlanWisdom&);
+
+public:
+   PlanWisdom()
+   : m_cpu(cpu_signature()), m_rec(0), m_nrec(0), m_mapped(0), m_mapped_len(0) { }
+
+   ~PlanWisdom() { release(); }
+
+   /// Returns the variant ID or -1, if the transform was not measured
+   int_t find(const PlanKey& key) const
+   {
+      int_t id = -1;
+      #pragma omp critical(gfft_plan_wisdom)
+      {
+	MapType::const_iterator it = m_map.find(key);
+	if (it != m_map.end())
+	  id = it->second;
+	else if (m_nrec > 0)
+	  id = findMapped(key);
+      }
+      return id;
+   }
+
+   void insert(const PlanKey& key, const id_t variant_id)
+   {
+      #pragma omp critical(gfft_plan_wisdom)
+      m_map[key] = variant_id;
+   }
+
+   /// Number of the variants measured in this process
+   uint_t size() const { return m_map.size(); }
+
+   /// Forgets all measured and imported variants
+   void clear()
+   {
+      #pragma omp critical(gfft_plan_wisdom)
+      {
+	m_map.clear();
+	release();
+      }
+   }
+
+   /// Maps the wisdom file into memory
+   /** Returns false, if the file can not be read or has wrong format.
+       The variants imported before are replaced, the measured ones are kept
+       and have priority.
+   */
+   bool import_from(const char* filename)
+   {
+      bool ok = false;
+      #pragma omp critical(gfft_plan_wisdom)
+      {
+	release();
+#ifdef GFFT_WISDOM_MMAP
+	const int fd = open(filename, O_RDONLY);
+	struct stat st;
+	if (fd >= 0 && fstat(fd, &st) == 0
+	    && static_cast<size_t>(st.st_size) >= sizeof(WisdomHeader)) {
+	  void* p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	  if (p != MAP_FAILED) {
+	    const WisdomHeader* h = static_cast<const WisdomHeader*>(p);
+	    if (valid(*h, st.st_size)) {
+	      m_mapped = p;
+	      m_mapped_len = st.st_size;
+	      m_rec = reinterpret_cast<const WisdomRecord*>(h + 1);
+	      m_nrec = h->count;
+	      ok = true;
+	    }
+	    else
+	      munmap(p, st.st_size);
+	  }
+	}
+	if (fd >= 0)
+	  close(fd);
+#else
+	std::FILE* f = std::fopen(filename, "rb");
+	WisdomHeader h;
+	if (f && std::fread(&h, sizeof(h), 1, f) == 1) {
+	  std::fseek(f, 0, SEEK_END);
+	  const long len = std::ftell(f);
+	  std::fseek(f, sizeof(h), SEEK_SET);
+	  if (len > 0 && valid(h, len))
+	    m_buf.resize(h.count);
+	  if (len > 0 && valid(h, len)
+	      && (h.count == 0 || std::fread(&m_buf[0], sizeof(WisdomRecord), h.count, f) == h.count)) {
+	    m_rec = h.count ? &m_buf[0] : 0;
+	    m_nrec = h.count;
+	    ok = true;
+	  }
+	  else
+	    m_buf.clear();
+	}
+	if (f)
+	  std::fclose(f);
+#endif
+      }
+      return ok;
+   }
+
+   /// Writes the measured and imported variants into the wisdom file
+   /** Returns false, if the file can not be written.
+       The file is written under a temporary name and renamed afterwards,
+       so that a mapped file stays valid.
+   */
+   bool export_to(const char* filename) const
+   {
+      std::vector<WisdomRecord> rec;
+      #pragma omp critical(gfft_plan_wisdom)
+      {
+	for (MapType::const_iterator it = m_map.begin(); it != m_map.end(); ++it)
+	  rec.push_back(WisdomRecord(m_cpu, it->first, it->second));
+	// the measured variants replace the imported ones
+	std::sort(rec.begin(), rec.end());
+	for (uint_t i=0; i<m_nrec; ++i)
+	  if (!std::binary_search(rec.begin(), rec.end(), m_rec[i]))
+	    rec.push_back(m_rec[i]);
+      }
+      std::sort(rec.begin(), rec.end());
+
+      WisdomHeader h;
+      std::memcpy(h.magic, WisdomMagic, 4);
+      h.version = WisdomVersion;
+      h.record_size = sizeof(WisdomRecord);
+      h.count = static_cast<uint32_t>(rec.size());
+
+      const std::string tmpname = std::string(filename) + ".tmp";
+      std::FILE* f = std::fopen(tmpname.c_str(), "wb");
+      if (!f) return false;
+      bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+      if (ok && !rec.empty())
+	ok = std::fwrite(&rec[0], sizeof(WisdomRecord), rec.size(), f) == rec.size();
+      ok = (std::fclose(f) == 0) && ok;
+#ifndef GFFT_WISDOM_MMAP
+      if (ok)
+	std::remove(filename);
+#endif
+      if (ok)
+	ok = std::rename(tmpname.c_str(), filename) == 0;
+      if (!ok)
+	std::remove(tmpname.c_str());
+      return ok;
+   }
+};
+
+}  //namespace GFFT
+
+#endif /*__gfftwisdom_h*/
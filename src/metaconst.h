@@ -0,0 +1,234 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+#ifndef __metaconst_h
+#define __metaconst_h
+
+/** \file
+    \brief Compile-time roots of unity by constexpr functions (C++14)
+
+    This is the backend of GetFirstRoot selected by GFFT_CONSTEXPR_ROOTS.
+    A root is the type ConstRoot<N,E,S> = exp(-S*2*pi*i*E/N), so the products
+    and powers of the roots (Mult, IPowBig) reduce to the integer arithmetic
+    on E and N instead of the big decimal numbers of metasincos.h.
+    Its real and imaginary parts are evaluated in long double by constexpr
+    functions into static constants, which Compute returns rounded to
+    the requested type.
+*/
+
+#if __cplusplus < 201402L
+#error "GFFT_CONSTEXPR_ROOTS requires C++14"
+#endif
+
+namespace MF {
+
+namespace ConstMath {
+
+static constexpr long double Pi = 3.141592653589793238462643383279502884L;
+
+constexpr int_t gcd(int_t a, int_t b)
+{
+   while (b != 0) {
+     const int_t t = a % b;
+     a = b;
+     b = t;
+   }
+   return a;
+}
+
+/// Taylor series of sin(x), |x| <= pi/4
+constexpr long double sin_series(const long double x)
+{
+   const long double x2 = x*x;
+   long double term = x, sum = x;
+   for (int k=2; term > 1e-25L || term < -1e-25L; k+=2) {
+     term *= -x2/(k*(k+1));
+     sum += term;
+   }
+   return sum;
+}
+
+/// Taylor series of cos(x), |x| <= pi/4
+constexpr long double cos_series(const long double x)
+{
+   const long double x2 = x*x;
+   long double term = 1, sum = 1;
+   for (int k=1; term > 1e-25L || term < -1e-25L; k+=2) {
+     term *= -x2/(k*(k+1));
+     sum += term;
+   }
+   return sum;
+}
+
+/// cos(2*pi*e/n) (part = 0) or sin(2*pi*e/n) (part = 1)
+/** The angle is reduced to [0,pi/4] by the symmetries as in direct_root.
+*/
+constexpr long double cos_sin_2pi(int_t e, const int_t n, const int part)
+{
+   e %= n;
+   if (e < 0) e += n;
+   // angle = pi/2*(q + r/n)
+   const int_t q = (4*e)/n;
+   const int_t r = 4*e - q*n;
+   long double c = 0, s = 0;
+   if (2*r <= n) {
+     c = cos_series(Pi/2*r/n);
+     s = sin_series(Pi/2*r/n);
+   }
+   else {
+     c = sin_series(Pi/2*(n-r)/n);
+     s = cos_series(Pi/2*(n-r)/n);
+   }
+   long double re = c, im = s;
+   if (q == 1)      { re = -s; im = c; }
+   else if (q == 2) { re = -c; im = -s; }
+   else if (q == 3) { re = s;  im = -c; }
+   return part ? im : re;
+}
+
+/// Newton iterations for sqrt(x), x > 0
+constexpr long double sqrt(const long double x)
+{
+   // the iterations decrease monotonically from y >= sqrt(x) until convergence
+   long double y = x > 1 ? x : 1;
+   for (;;) {
+     const long double z = (y + x/y)/2;
+     if (z >= y) return y;
+     y = z;
+   }
+}
+
+} // namespace ConstMath
+
+
+/// Real part cos(2*pi*E/N) of ConstRoot
+template<int_t N, int_t E>
+struct ConstCos {
+   static constexpr long double value = ConstMath::cos_sin_2pi(E, N, 0);
+};
+
+template<int_t N, int_t E>
+constexpr long double ConstCos<N,E>::value;
+
+/// Imaginary part -S*sin(2*pi*E/N) of ConstRoot
+template<int_t N, int_t E, int S>
+struct ConstSin {
+   static constexpr long double value = -S*ConstMath::cos_sin_2pi(E, N, 1);
+};
+
+template<int_t N, int_t E, int S>
+constexpr long double ConstSin<N,E,S>::value;
+
+/// Square root of the integer N
+template<int_t N>
+struct ConstSqrt {
+   static constexpr long double value = ConstMath::sqrt(N);
+};
+
+template<int_t N>
+constexpr long double ConstSqrt<N>::value;
+
+
+/// Root of unity exp(-S*2*pi*i*E/N)
+/*!
+The interface is the one of MComplex: the parts Re and Im are passed to Compute.
+ConstRootOf gives the reduced form with 0 <= E < N and gcd(E,N) = 1,
+so that the equal roots are the same type.
+*/
+template<int_t N, int_t E, int S>
+struct ConstRoot {
+   typedef ConstCos<N,E> Re;
+   typedef ConstSin<N,E,S> Im;
+};
+
+template<int_t N, int_t E, int S>
+struct ConstRootOf {
+   static const int_t E0 = (E % N + N) % N;
+   static const int_t G = ConstMath::gcd(E0 == 0 ? N : E0, N);
+   typedef ConstRoot<N/G, E0/G, S> Result;
+};
+
+} // namespace MF
+
+// Mult is declared in the global namespace (sbigint.h)
+template<int_t N1, int_t E1, int_t N2, int_t E2, int S1, int S2>
+class Mult<MF::ConstRoot<N1,E1,S1>, MF::ConstRoot<N2,E2,S2> > {
+   static const int_t L = N1/MF::ConstMath::gcd(N1,N2)*N2;
+   // the second root with the sign of the first one
+   static const int_t E2S = (S1 == S2) ? E2 : N2 - E2;
+public:
+   typedef typename MF::ConstRootOf<L, E1*(L/N1) + E2S*(L/N2), S1>::Result Result;
+};
+
+namespace MF {
+
+template<int_t N, int_t E, int S, int_t P>
+struct IPowBig<ConstRoot<N,E,S>,P> {
+   typedef typename ConstRootOf<N, (E*P) % N, S>::Result Result;
+};
+
+template<int_t N, int_t E, int S>
+struct IPowBig<ConstRoot<N,E,S>,1> {
+   typedef ConstRoot<N,E,S> Result;
+};
+
+template<int_t N, int_t E, int S>
+struct IPowBig<ConstRoot<N,E,S>,0> {
+   typedef ConstRoot<1,0,S> Result;
+};
+
+template<int_t N, int_t E, int Accuracy, class RetType>
+struct Compute<ConstCos<N,E>,Accuracy,RetType> {
+   static constexpr RetType value() { return static_cast<RetType>(ConstCos<N,E>::value); }
+};
+
+template<int_t N, int_t E, int S, int Accuracy, class RetType>
+struct Compute<ConstSin<N,E,S>,Accuracy,RetType> {
+   static constexpr RetType value() { return static_cast<RetType>(ConstSin<N,E,S>::value); }
+};
+
+template<int_t N, int Accuracy, class RetType>
+struct Compute<ConstSqrt<N>,Accuracy,RetType> {
+   static constexpr RetType value() { return static_cast<RetType>(ConstSqrt<N>::value); }
+};
+
+
+/// Table of the roots W^k, k=0,...,N-1, of W = exp(-S*2*pi*i/N) in .rodata
+/*!
+\tparam T value type of the table
+
+The constexpr counterpart of GenerateRootList: re[k] and im[k]
+are the real and imaginary parts of W^k rounded to T.
+*/
+template<int_t N, int S, typename T>
+struct ConstRootTable {
+   struct Data {
+      T re[N], im[N];
+      constexpr Data() : re(), im()
+      {
+	for (int_t k=0; k<N; ++k) {
+	  re[k] = static_cast<T>(ConstMath::cos_sin_2pi(k, N, 0));
+	  im[k] = static_cast<T>(-S*ConstMath::cos_sin_2pi(k, N, 1));
+	}
+      }
+   };
+   static constexpr Data data = Data();
+};
+
+template<int_t N, int S, typename T>
+constexpr typename ConstRootTable<N,S,T>::Data ConstRootTable<N,S,T>::data;
+
+} // namespace MF
+
+#endif /*__metaconst_h*/
@@ -57,6 +57,18 @@ struct IPow<N,0> {
 };
 
 
+/// Smallest power of two, which is not less than N
+template<int_t N, int_t P = 1, bool C = (P >= N)>
+struct NextPowerOf2 {
+  static const int_t value = NextPowerOf2<N,2*P>::value;
+};
+
+template<int_t N, int_t P>
+struct NextPowerOf2<N,P,true> {
+  static const int_t value = P;
+};
+
+
 template<class N, int_t P>
 struct IPowBig {
   typedef typename Mult<N, typename IPowBig<N,P-1>::Result>::Result Result;
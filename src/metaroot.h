@@ -25,6 +25,10 @@
 #include "metasqrt.h"
 #include "metacomplex.h"
 
+#ifdef GFFT_CONSTEXPR_ROOTS
+#include "metaconst.h"
+#endif
+
 namespace MF {
   
 // template<class W, class W1, int_t N, int_t I, int S>
@@ -101,6 +105,21 @@ struct GenerateSymmetricPart<Loki::NullType> {
 };
 
 
+/// First root of unity W = exp(-S*2*pi*i/N)
+/** The parts W::Re and W::Im are evaluated by Compute with the Accuracy.
+    If GFFT_CONSTEXPR_ROOTS is defined, W is a ConstRoot (see metaconst.h),
+    otherwise MComplex of the big decimal numbers.
+*/
+#ifdef GFFT_CONSTEXPR_ROOTS
+
+template<int_t N, int S, int Accuracy>
+class GetFirstRoot {
+public:
+  typedef typename ConstRootOf<N,1,S>::Result Result;
+};
+
+#else
+
 template<int_t N, int S, int Accuracy>
 class GetFirstRoot {
   //typedef typename SinPiDecimal<1,N,Accuracy>::Result Sin1;
@@ -119,6 +138,18 @@ public:
   typedef MComplex<WR,WI> Result;
 };
 
+#endif /* GFFT_CONSTEXPR_ROOTS */
+
+/// Square root of N as the argument of Compute
+template<int_t N, int Accuracy>
+struct SqrtOf {
+#ifdef GFFT_CONSTEXPR_ROOTS
+  typedef ConstSqrt<N> Result;
+#else
+  typedef typename SqrtDecAcc<SInt<N>,Accuracy>::Result Result;
+#endif
+};
+
 
 
 template<int_t N, int S, int Accuracy>
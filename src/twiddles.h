@@ -20,6 +20,12 @@
 */
 
 #include "metaroot.h"
+#include "gfftcache.h"
+
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <new>
 
 namespace GFFT {
 
@@ -172,6 +178,24 @@ Computes twiddle factors,
 e.g. cos(2*pi/N),...,cos(2*K*pi/N) and sin(2*pi/N),...,sin(2*K*pi/N).
 It is used for prime factors greater than 3.
 */
+#ifdef GFFT_CONSTEXPR_ROOTS
+
+// The twiddle factors are copied from the constexpr table
+template<typename T, int_t N, int S, int_t K>
+struct ComputeTwiddles
+{
+  static void apply(T* c, T* s)
+  {
+    typedef ConstRootTable<N,-S,T> Table;
+    for (int_t k=0; k<K; ++k) {
+      c[k] = Table::data.re[k+1];
+      s[k] = Table::data.im[k+1];
+    }
+  }
+};
+
+#else
+
 template<typename T, int_t N, int S, int_t K>
 struct ComputeTwiddles
 {
@@ -195,6 +219,8 @@ struct ComputeTwiddles<T,N,S,1>
   }
 };
 
+#endif /* GFFT_CONSTEXPR_ROOTS */
+
 template<typename T, int_t N, int S, int_t K>
 struct ComputeTwiddlesHolder
 {
@@ -207,6 +233,328 @@ struct ComputeTwiddlesHolder
 
 ///////////////////////////////////////////////////////////////////
 
+/// Alignment in bytes of the twiddle tables: cache line and the widest vector register
+static const int_t TwiddleAlign = 64;
+
+/** \var static const bool TwiddleTables
+The scaled DFT stages (DFTk_x_Im_T) load the twiddle factors from TwiddleTable.
+Define GFFT_TWIDDLE_RECURRENCE to compute them by the recurrence
+of ComputeRoots instead, which needs no memory for the tables.
+*/
+#ifdef GFFT_TWIDDLE_RECURRENCE
+static const bool TwiddleTables = false;
+#else
+static const bool TwiddleTables = true;
+#endif
+
+/// Root of unity exp(-S*2*pi*i*e/n) evaluated directly
+/** The angle is reduced to [0,pi/4] by the symmetries of sine and cosine
+    and computed in long double, so the error doesn't depend on e.
+*/
+inline void direct_root(int_t e, const int_t n, const int S, long double& re, long double& im)
+{
+   static const long double pi2 = 1.570796326794896619231321691639751442L;
+   e %= n;
+   if (e < 0) e += n;
+   // angle = pi/2*(q + r/n)
+   const int_t q = (4*e)/n;
+   const int_t r = 4*e - q*n;
+   long double c, s;
+   if (2*r <= n) {
+     c = std::cos(pi2*r/n);
+     s = std::sin(pi2*r/n);
+   }
+   else {
+     c = std::sin(pi2*(n-r)/n);
+     s = std::cos(pi2*(n-r)/n);
+   }
+   switch (q) {
+     case 0: re = c;  im = s;  break;
+     case 1: re = -s; im = c;  break;
+     case 2: re = -c; im = -s; break;
+     default: re = s; im = -c;
+   }
+   im = -S*im;
+}
+
+/// Array of n values aligned on TwiddleAlign bytes
+template<typename T>
+class AlignedArray
+{
+   void* m_mem;
+   T* m_data;
+   int_t m_size;
+
+   void allocate(const int_t n)
+   {
+      m_size = n;
+      m_mem = std::malloc(n*sizeof(T) + TwiddleAlign);
+      if (!m_mem) throw std::bad_alloc();
+      const size_t a = reinterpret_cast<size_t>(m_mem) + TwiddleAlign - 1;
+      m_data = reinterpret_cast<T*>(a - a%TwiddleAlign);
+   }
+
+public:
+   explicit AlignedArray(const int_t n) { allocate(n); }
+   ~AlignedArray() { std::free(m_mem); }
+
+   T* data() { return m_data; }
+   const T* data() const { return m_data; }
+   int_t size() const { return m_size; }
+
+private:
+   AlignedArray(const AlignedArray&);
+   AlignedArray& operator=(const AlignedArray&);
+};
+
+/// Layout of a shared twiddle table
+enum TwiddleLayout {
+   TwiddleRows,     ///< rows of W^(k*j) of TwiddleTable
+   TwiddleColumns,  ///< W^(j*m) of the runtime stages, real parts followed by imaginary parts
+   TwiddleRoots,    ///< W^e, e=0,...,n-1, real parts followed by imaginary parts
+   TwiddleBluestein,   ///< chirp of Bluestein's algorithm and the spectrum of its kernel
+   TwiddleRaderKernel, ///< spectrum of the kernel of Rader's algorithm
+   TwiddleRaderIndex   ///< g^m and g^(-m) mod n of Rader's algorithm
+};
+
+/// Key of a shared twiddle table in TwiddleCache
+/** Length n of the root W = exp(-sign*2*pi*i/n), radix k and TwiddleLayout.
+    k is 1 for TwiddleRoots and the tables of Rader's algorithm and
+    the convolution length for TwiddleBluestein.
+    The precision is the value type of TwiddleCache.
+*/
+struct TwiddleKey
+{
+   int_t n, k, sign, layout;
+
+   TwiddleKey(const int_t n_, const int_t k_, const int_t sign_, const int_t layout_)
+   : n(n_), k(k_), sign(sign_), layout(layout_) { }
+
+   bool operator==(const TwiddleKey& t) const
+   {
+      return n == t.n && k == t.k && sign == t.sign && layout == t.layout;
+   }
+
+   bool operator<(const TwiddleKey& t) const
+   {
+      if (n != t.n) return n < t.n;
+      if (k != t.k) return k < t.k;
+      if (sign != t.sign) return sign < t.sign;
+      return layout < t.layout;
+   }
+
+   uint_t hash() const
+   {
+      uint_t h = static_cast<uint_t>(n);
+      h = h*31 + static_cast<uint_t>(k);
+      h = h*31 + static_cast<uint_t>(sign + 1);
+      h = h*31 + static_cast<uint_t>(layout);
+      return h ^ (h >> 16);
+   }
+};
+
+/// Process-wide cache of the read-only twiddle tables
+/*!
+\tparam T value type of the tables, i.e. their precision
+
+Every table is computed once by the first transform object, which needs it,
+and is shared afterwards by all transform objects of all threads.
+The lookup is lock-free as in PlanCache. The tables are aligned
+on TwiddleAlign bytes and are released at the end of the program only,
+so the transform objects keep just the pointers to them.
+*/
+template<typename T>
+class TwiddleCache
+{
+   typedef PlanCache<AlignedArray<T>, 64, TwiddleKey> Cache;
+
+   static Cache& instance()
+   {
+      static Cache cache;
+      return cache;
+   }
+
+public:
+   typedef AlignedArray<T> Table;
+
+   /// Returns the shared table or null, if it isn't computed yet
+   static const Table* find(const TwiddleKey& key) { return instance().find(key); }
+
+   /// Shares the new table and returns the cached one (see PlanCache::insert)
+   static const Table* insert(const TwiddleKey& key, Table* table) { return instance().insert(key, table); }
+};
+
+/// Shared W^e, e=0,...,n-1, of the root W = exp(-S*2*pi*i/n)
+/** The n real parts are followed by n imaginary parts.
+*/
+template<typename T>
+const T* shared_roots(const int_t n, const int S)
+{
+   const TwiddleKey key(n, 1, S, TwiddleRoots);
+   const AlignedArray<T>* t = TwiddleCache<T>::find(key);
+   if (!t) {
+     AlignedArray<T>* a = new AlignedArray<T>(2*n);
+     T* w = a->data();
+     for (int_t e=0; e<n; ++e) {
+       long double re, im;
+       direct_root(e, n, S, re, im);
+       w[e] = static_cast<T>(re);
+       w[n+e] = static_cast<T>(im);
+     }
+     t = TwiddleCache<T>::insert(key, a);
+   }
+   return t->data();
+}
+
+/// Shared twiddles W^(j*m) of the scaled DFT(K) of M columns
+/** The root is W = exp(-S*2*pi*i/(K*M)), j=1,...,M-1, m=1,...,K-1.
+    The twiddles of the column j start at the position (j-1)*(K-1)
+    (see RuntimeRadix::stage), the (M-1)*(K-1) real parts are followed
+    by the imaginary parts.
+*/
+template<typename T>
+const T* shared_stage_twiddles(const int_t K, const int_t M, const int S)
+{
+   const TwiddleKey key(K*M, K, S, TwiddleColumns);
+   const AlignedArray<T>* t = TwiddleCache<T>::find(key);
+   if (!t) {
+     const int_t L = K*M;
+     const int_t NT = (M-1)*(K-1);
+     AlignedArray<T>* a = new AlignedArray<T>(NT > 0 ? 2*NT : 2);
+     T* w = a->data();
+     for (int_t j=1; j<M; ++j)
+       for (int_t m=1; m<K; ++m) {
+	 long double re, im;
+	 direct_root(j*m, L, S, re, im);
+	 w[(j-1)*(K-1)+m-1] = static_cast<T>(re);
+	 w[NT+(j-1)*(K-1)+m-1] = static_cast<T>(im);
+       }
+     t = TwiddleCache<T>::insert(key, a);
+   }
+   return t->data();
+}
+
+/// Shared chirp and kernel spectrum of Bluestein's algorithm for the length n
+/*!
+\param m length of the cyclic convolution
+\param S sign of the transform
+\param fft forward transform of the length m, which computes the spectrum
+
+The chirp w^(i^2/2) = exp(-S*pi*i^2/n), i=0,...,n-1, starts the table,
+the n real parts are followed by n imaginary parts. The interleaved
+spectrum of the kernel conj(w^(i^2/2)) scaled by 1/m comes next at 2*n.
+\sa Bluestein, RuntimeRadixBluestein
+*/
+template<typename T, class FFT>
+const T* shared_bluestein(const int_t n, const int_t m, const int S, FFT& fft)
+{
+   const TwiddleKey key(n, m, S, TwiddleBluestein);
+   const AlignedArray<T>* t = TwiddleCache<T>::find(key);
+   if (!t) {
+     const int_t M2 = 2*m;
+     AlignedArray<T>* a = new AlignedArray<T>(2*n + M2);
+     T* wr = a->data();
+     T* wi = wr + n;
+     // i^2 is taken modulo 2n
+     for (int_t i=0; i<n; ++i) {
+       long double re, im;
+       direct_root((i*i) % (2*n), 2*n, S, re, im);
+       wr[i] = static_cast<T>(re);
+       wi[i] = static_cast<T>(im);
+     }
+
+     std::vector<T> b(M2, T(0));
+     b[0] = wr[0];
+     b[1] = -wi[0];
+     for (int_t i=1; i<n; ++i) {
+       b[2*i]   = b[M2-2*i]   = wr[i];
+       b[2*i+1] = b[M2-2*i+1] = -wi[i];
+     }
+     T* spec = wi + n;
+     fft.apply(&b[0], spec);
+     for (int_t i=0; i<M2; ++i)
+       spec[i] /= m;
+     t = TwiddleCache<T>::insert(key, a);
+   }
+   return t->data();
+}
+
+/// Precomputed twiddle factors of a scaled DFT stage
+/*!
+\tparam K radix
+\tparam M number of the columns
+\tparam T value type of the table: double or float
+\tparam S sign of the transform (-1 for inverse)
+
+Refers to W^(k*j), k=1,...,K-1, j=0,...,M-1, of the root W = exp(-S*2*pi*i/(K*M))
+as interleaved complex numbers. The columns of every k are contiguous
+and the rows start at TwiddleAlign bytes, so Width consecutive columns
+are loaded into a vector register at once: W^(k*j) is at get(k) + 2*j.
+The table is computed by the split-table method:
+W^e = W^(B*(e/B)) * W^(e%B), where both factors are evaluated by direct_root
+and multiplied in long double, so the error doesn't grow with j.
+It is computed once and shared by all stages of the same K, M, S and T
+through TwiddleCache.
+*/
+template<int_t K, int_t M, typename T, int S, bool On = TwiddleTables>
+class TwiddleTable
+{
+   static const int_t NW = K*M;
+   static const int_t PerLine = TwiddleAlign/(2*sizeof(T));
+   static const int_t RowLength = 2*((M + PerLine - 1)/PerLine*PerLine);
+
+   const T* m_tab;
+
+   static AlignedArray<T>* compute()
+   {
+      typedef long double LT;
+      int_t b = 1;
+      while (b*b < NW) b *= 2;
+      const int_t nh = (NW + b - 1)/b;
+      std::vector<LT> lo(2*b), hi(2*nh);
+      for (int_t i=0; i<b; ++i)
+	direct_root(i, NW, S, lo[2*i], lo[2*i+1]);
+      for (int_t i=0; i<nh; ++i)
+	direct_root(i*b, NW, S, hi[2*i], hi[2*i+1]);
+
+      AlignedArray<T>* tab = new AlignedArray<T>((K-1)*RowLength);
+      for (int_t k=1; k<K; ++k) {
+	T* row = tab->data() + (k-1)*RowLength;
+	for (int_t j=0; j<M; ++j) {
+	  const int_t e = (k*j)%NW;
+	  const LT* h = &hi[2*(e/b)];
+	  const LT* l = &lo[2*(e%b)];
+	  row[2*j]   = static_cast<T>(h[0]*l[0] - h[1]*l[1]);
+	  row[2*j+1] = static_cast<T>(h[0]*l[1] + h[1]*l[0]);
+	}
+      }
+      return tab;
+   }
+
+public:
+   TwiddleTable()
+   {
+      const TwiddleKey key(NW, K, S, TwiddleRows);
+      const AlignedArray<T>* tab = TwiddleCache<T>::find(key);
+      if (!tab)
+	tab = TwiddleCache<T>::insert(key, compute());
+      m_tab = tab->data();
+   }
+
+   /// Row of W^(k*j), j=0,...,M-1
+   const T* get(const int_t k) const { return m_tab + (k-1)*RowLength; }
+};
+
+// Empty table of the recurrence mode
+template<int_t K, int_t M, typename T, int S>
+class TwiddleTable<K,M,T,S,false>
+{
+public:
+   const T* get(const int_t) const { return 0; }
+};
+
+///////////////////////////////////////////////////////////////////
+
 template<int_t K, typename VType>
 class RootsContainer
 {
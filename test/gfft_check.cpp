@@ -0,0 +1,769 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+/** \file
+    \brief Check the transform features against the direct DFT in long double precision
+
+Every check computes the maximal error relative to the largest magnitude
+of the reference and compares it with the bound Tol*eps*(log2(n)+1).
+The program returns 1, if any check fails.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#include "gfftlib.h"
+
+using namespace std;
+
+using namespace GFFT;
+
+typedef long double LD;
+typedef complex<LD> LC;
+
+// error bound in units of eps*(log2(n)+1)
+static const double Tol = 16.;
+
+static const char* WisdomFile = "gfft_check.wisdom";
+
+// compiled lengths: prime leaf (17), Bluestein (47), mixed radix and powers of primes,
+// Rader in the scaled stages of the radix 17 and 19 (34, 57, 289)
+typedef TYPELIST_8(SIntID<17>, SIntID<47>, SIntID<60>, SIntID<81>, SIntID<1000>,
+                   SIntID<34>, SIntID<57>, SIntID<289>) MixedList;
+// powers of two for the plan variants
+typedef TYPELIST_4(SIntID<8>, SIntID<64>, SIntID<512>, SIntID<4096>) Power2List;
+typedef TYPELIST_2(Serial, OpenMP<4>) ParallList;
+typedef TYPELIST_2(DFT, IDFT) ComplexTypes;
+
+typedef GenerateTransform<MixedList, DOUBLE, ComplexTypes, SIntID<1>, ParallList, OUT_OF_PLACE> MixedSet;
+typedef GenerateTransform<TYPELIST_3(SIntID<17>, SIntID<81>, SIntID<289>), COMPLEX_DOUBLE, ComplexTypes,
+                          SIntID<1>, ParallList, IN_PLACE> MixedInpSet;
+typedef GenerateTransform<Power2List, DOUBLE, ComplexTypes, SIntID<1>, ParallList,
+                          OUT_OF_PLACE, PlanVariantGroup::FullList> PlanSet;
+typedef GenerateTransform<Power2List, DOUBLE, ComplexTypes, SIntID<1>, ParallList,
+                          IN_PLACE, PlanVariantGroup::FullList> PlanInpSet;
+// the parallel scaled stage of a large M: radix 4 and the composite radix 9 of 3^8
+typedef GenerateTransform<TYPELIST_2(SIntID<8192>, SIntID<6561>), DOUBLE, ComplexTypes,
+                          SIntID<1>, OpenMP<4>, OUT_OF_PLACE> LargeSet;
+typedef GenerateTransform<TYPELIST_2(SIntID<8192>, SIntID<6561>), DOUBLE, ComplexTypes,
+                          SIntID<1>, OpenMP<4>, IN_PLACE> LargeInpSet;
+typedef GenerateTransform<TYPELIST_2(SIntID<8>, SIntID<16>), DOUBLE, ComplexTypes,
+                          TYPELIST_2(SIntID<2>, SIntID<3>), ParallList, OUT_OF_PLACE> MultiSet;
+typedef GenerateTransform<TYPELIST_3(SIntID<8>, SIntID<15>, SIntID<64>), DOUBLE,
+                          TYPELIST_2(RDFT, IRDFT), SIntID<1>, ParallList, OUT_OF_PLACE> RealSet;
+typedef GenerateTransform<TYPELIST_3(SIntID<64>, SIntID<256>, SIntID<1024>), COMPLEX_DOUBLE,
+                          DFT, SIntID<1>, Serial, OUT_OF_PLACE> ConvSet;
+typedef TYPELIST_3(SIntID<64>, SIntID<243>, SIntID<1024>) ISAList;
+
+static int_t Failures = 0;
+
+/// Maximal error of a group of checks
+class Accuracy
+{
+   const char* m_name;
+   double m_err, m_ratio;
+public:
+   explicit Accuracy(const char* name) : m_name(name), m_err(0), m_ratio(0) { }
+
+   /// Adds the relative error err of a transform of the length n with the machine epsilon eps
+   void add(const double err, const int_t n, const double eps)
+   {
+      const double tol = Tol*eps*(log(static_cast<double>(n))/log(2.) + 1);
+      if (err > m_err) m_err = err;
+      // NaN fails as well
+      const double r = (err <= tol) ? err/tol : 2.;
+      if (r > m_ratio) m_ratio = r;
+   }
+
+   /// Adds a condition, which must be true
+   void require(const bool c)
+   {
+      if (!c) m_ratio = 2.;
+   }
+
+   ~Accuracy()
+   {
+      const bool ok = (m_ratio <= 1.);
+      cout << "  " << setw(28) << left << m_name << right
+           << setw(12) << scientific << setprecision(3) << m_err
+           << (ok ? "   passed" : "   FAILED") << endl;
+      if (!ok) ++Failures;
+   }
+};
+
+vector<LC> random_data(const int_t n)
+{
+   vector<LC> x(n);
+   for (int_t i=0; i<n; ++i)
+     x[i] = LC(rand()/LD(RAND_MAX) - 0.5L, rand()/LD(RAND_MAX) - 0.5L);
+   return x;
+}
+
+// direct DFT, the backward one is scaled by 1/n as the transforms IDFT
+vector<LC> dft(const vector<LC>& x, const int sign)
+{
+   const int_t n = x.size();
+   vector<LC> w(n), y(n);
+   for (int_t j=0; j<n; ++j) {
+     const LD a = -2*M_PIl*sign*j/n;
+     w[j] = LC(cosl(a), sinl(a));
+   }
+   for (int_t k=0; k<n; ++k) {
+     LC s = 0;
+     int_t idx = 0;
+     for (int_t j=0; j<n; ++j) {
+       s += x[j]*w[idx];
+       idx += k;
+       if (idx >= n) idx -= n;
+     }
+     y[k] = (sign < 0) ? s/LD(n) : s;
+   }
+   return y;
+}
+
+// multi-dimensional DFT of the length n in every dimension by the DFT along every axis
+vector<LC> dft_nd(vector<LC> x, const int_t n, const int sign)
+{
+   const int_t size = x.size();
+   vector<LC> l(n);
+   for (int_t s=1; s<size; s*=n)
+     for (int_t o=0; o<size/(n*s); ++o)
+       for (int_t i=0; i<s; ++i) {
+	 for (int_t k=0; k<n; ++k) l[k] = x[o*n*s + i + k*s];
+	 l = dft(l, sign);
+	 for (int_t k=0; k<n; ++k) x[o*n*s + i + k*s] = l[k];
+       }
+   return x;
+}
+
+template<typename T>
+void to_interleaved(const vector<LC>& x, T* d, const int_t stride = 1)
+{
+   for (size_t i=0; i<x.size(); ++i) {
+     d[2*i*stride]   = static_cast<T>(x[i].real());
+     d[2*i*stride+1] = static_cast<T>(x[i].imag());
+   }
+}
+
+// error of the interleaved data d relative to the largest magnitude of r
+template<typename T>
+double rel_error(const vector<LC>& r, const T* d, const int_t stride = 1)
+{
+   LD err = 0, norm = 0;
+   for (size_t i=0; i<r.size(); ++i) {
+     err = max(err, abs(r[i] - LC(d[2*i*stride], d[2*i*stride+1])));
+     norm = max(norm, abs(r[i]));
+   }
+   return static_cast<double>(err/(norm > 0 ? norm : 1));
+}
+
+static const double EpsD = numeric_limits<double>::epsilon();
+
+// the plan variant var (PlanVariant::ID) of the compiled transform
+template<class Set>
+typename Set::ObjectType* create(Set& set, const int_t n, const int_t vtype_id, const int_t tr, 
+                                 const int_t parall_id, const int_t place_id, const int_t var)
+{
+   return set.dispatch.find(n, vtype_id, tr, 1, parall_id, place_id, set.dispatch.variant(var))();
+}
+
+// runs and deletes the transform f of the length n, returns its error
+template<class VType>
+double run_oop(AbstractFFT_oop<typename VType::ValueType>* f, const int_t n, const int_t tr)
+{
+   typedef typename VType::ValueType T;
+   typedef typename VType::base_type BT;
+   vector<LC> x = random_data(n);
+   vector<BT> src(2*n), dst(2*n);
+   to_interleaved(x, &src[0]);
+   f->fft(reinterpret_cast<T*>(&src[0]), reinterpret_cast<T*>(&dst[0]));
+   delete f;
+   return rel_error(dft(x, (tr == IDFT::ID) ? -1 : 1), &dst[0]);
+}
+
+template<class VType>
+double run_inp(AbstractFFT_inp<typename VType::ValueType>* f, const int_t n, const int_t tr)
+{
+   typedef typename VType::ValueType T;
+   typedef typename VType::base_type BT;
+   vector<LC> x = random_data(n);
+   vector<BT> d(2*n);
+   to_interleaved(x, &d[0]);
+   f->fft(reinterpret_cast<T*>(&d[0]));
+   delete f;
+   return rel_error(dft(x, (tr == IDFT::ID) ? -1 : 1), &d[0]);
+}
+
+// compiled lengths including the primes of Rader and Bluestein
+void check_compiled()
+{
+   Accuracy c("compiled, Rader, Bluestein");
+   MixedSet set;
+   MixedInpSet inp;
+   static const int_t Lens[] = { 17, 47, 60, 81, 1000, 34, 57, 289 };
+   static const int_t InpLens[] = { 17, 81, 289 };
+   for (int_t i=0; i<8; ++i)
+     for (int_t tr=0; tr<2; ++tr)
+       for (int_t p=0; p<2; ++p)
+	 c.add(run_oop<DOUBLE>(set.CreateTransformObject(Lens[i], DOUBLE::ID, tr, 1, p ? 3 : 0, OUT_OF_PLACE::ID), Lens[i], tr), Lens[i], EpsD);
+   for (int_t i=0; i<3; ++i)
+     for (int_t tr=0; tr<2; ++tr)
+       for (int_t p=0; p<2; ++p)
+	 c.add(run_inp<COMPLEX_DOUBLE>(inp.CreateTransformObject(InpLens[i], COMPLEX_DOUBLE::ID, tr, 1, p ? 3 : 0, IN_PLACE::ID), InpLens[i], tr), InpLens[i], EpsD);
+}
+
+// every plan variant of the powers of two and the default plans of OpenMP for large lengths
+void check_variants()
+{
+   Accuracy c("plan variants");
+   PlanSet set;
+   PlanInpSet inp;
+   LargeSet large;
+   LargeInpSet large_inp;
+   static const int_t Large[] = { 8192, 6561 };
+   for (int_t i=0; i<2; ++i)
+     for (int_t tr=0; tr<2; ++tr) {
+       const int_t n = Large[i];
+       c.add(run_oop<DOUBLE>(large.CreateTransformObject(n, DOUBLE::ID, tr, 1, 3, OUT_OF_PLACE::ID), n, tr), n, EpsD);
+       c.add(run_inp<DOUBLE>(large_inp.CreateTransformObject(n, DOUBLE::ID, tr, 1, 3, IN_PLACE::ID), n, tr), n, EpsD);
+     }
+   static const int_t Vars[] = { DefaultPlan::ID, DescendingPlan::ID, SplitPlan::ID, DescendingSplitPlan::ID,
+                                 Radix8Plan::ID, Radix16Plan::ID };
+   for (int_t v=0; v<6; ++v)
+     for (int_t n=8; n<=4096; n*=8)
+       for (int_t tr=0; tr<2; ++tr)
+	 for (int_t p=0; p<2; ++p) {
+	   c.add(run_oop<DOUBLE>(create(set, n, DOUBLE::ID, tr, p ? 3 : 0, OUT_OF_PLACE::ID, Vars[v]), n, tr), n, EpsD);
+	   c.add(run_inp<DOUBLE>(create(inp, n, DOUBLE::ID, tr, p ? 3 : 0, IN_PLACE::ID, Vars[v]), n, tr), n, EpsD);
+	 }
+}
+
+// MEASURE keeps the fastest variant in the plan cache and in the wisdom file
+void check_planner()
+{
+   Accuracy c("measure, wisdom");
+   const PlanKey key(512, DOUBLE::ID, DFT::ID, 1, 3, OUT_OF_PLACE::ID);
+   int_t id = -1;
+   {
+     PlanSet set;
+     PlanSet::ObjectType* f = set.GetTransformObject(512, DOUBLE::ID, DFT::ID, 1, 3, OUT_OF_PLACE::ID, MEASURE);
+     c.require(f != 0 && f == set.GetTransformObject(512, DOUBLE::ID, DFT::ID, 1, 3, OUT_OF_PLACE::ID));
+     vector<LC> x = random_data(512);
+     vector<double> src(1024), dst(1024);
+     to_interleaved(x, &src[0]);
+     f->fft(&src[0], &dst[0]);
+     c.add(rel_error(dft(x, 1), &dst[0]), 512, EpsD);
+
+     id = set.wisdom.find(key);
+     c.require(id >= 0 && set.dispatch.variant(id) >= 0);
+     c.require(set.wisdom.export_to(WisdomFile));
+   }
+   PlanSet set(WisdomFile);
+   c.require(set.wisdom.find(key) == id);
+   c.require(set.wisdom.find(PlanKey(64, DOUBLE::ID, DFT::ID, 1, 3, OUT_OF_PLACE::ID)) < 0);
+   remove(WisdomFile);
+}
+
+// the objects of the plan cache requested and used by several threads at once,
+// the runtime ones take their scratch buffers from the pools
+void check_plan_cache()
+{
+   Accuracy c("plan cache");
+   MixedSet set;
+   static const int_t Lens[] = { 17, 47, 60, 81, 1000, 1009 };
+   const int NT = 8;
+   for (int_t i=0; i<6; ++i)
+     for (int_t tr=0; tr<2; ++tr) {
+       const int_t n = Lens[i];
+       vector<LC> x = random_data(n);
+       vector<double> src(2*n), dst(2*n*NT);
+       to_interleaved(x, &src[0]);
+       vector<MixedSet::ObjectType*> f(NT);
+       #pragma omp parallel for num_threads(NT)
+       for (int t=0; t<NT; ++t) {
+	 f[t] = set.GetTransformObject(n, DOUBLE::ID, tr, 1, 0, OUT_OF_PLACE::ID);
+	 f[t]->fft(&src[0], &dst[2*n*t]);
+       }
+       const vector<LC> r = dft(x, tr ? -1 : 1);
+       for (int t=0; t<NT; ++t) {
+	 c.require(f[t] != 0 && f[t] == f[0]);
+	 c.add(rel_error(r, &dst[2*n*t]), n, EpsD);
+       }
+     }
+}
+
+// lengths, which are not compiled in, are planned at runtime
+void check_runtime()
+{
+   Accuracy c("runtime fallback");
+   MixedSet set;
+   MixedInpSet inp;
+   static const int_t Lens[] = { 1, 2, 12, 97, 100, 1009, 2310, 3072, 4099 };
+   for (int_t i=0; i<9; ++i)
+     for (int_t tr=0; tr<2; ++tr)
+       for (int_t p=0; p<2; ++p) {
+	 c.add(run_oop<DOUBLE>(set.CreateTransformObject(Lens[i], DOUBLE::ID, tr, 1, p ? 3 : 0, OUT_OF_PLACE::ID), Lens[i], tr), Lens[i], EpsD);
+	 c.add(run_inp<COMPLEX_DOUBLE>(inp.CreateTransformObject(Lens[i], COMPLEX_DOUBLE::ID, tr, 1, p ? 3 : 0, IN_PLACE::ID), Lens[i], tr), Lens[i], EpsD);
+       }
+}
+
+// batches of transforms with a gap between the arrays
+void check_fft_many()
+{
+   Accuracy c("fft_many");
+   typedef complex<double> C;
+   MixedSet set;
+   MixedInpSet inp;
+   static const int_t Lens[] = { 17, 60, 81, 97, 1000 };
+   const int_t B = 5;
+   for (int_t i=0; i<5; ++i)
+     for (int_t tr=0; tr<2; ++tr)
+       for (int_t p=0; p<2; ++p) {
+	 // the distance in complex numbers
+	 const int_t n = Lens[i], dist = n + 3;
+	 vector<LC> x = random_data(dist*B);
+	 vector<double> src(2*dist*B), dst(2*dist*B);
+	 vector<C> d(dist*B);
+	 to_interleaved(x, &src[0]);
+	 to_interleaved(x, reinterpret_cast<double*>(&d[0]));
+	 MixedSet::ObjectType* f = set.CreateTransformObject(n, DOUBLE::ID, tr, 1, p ? 3 : 0, OUT_OF_PLACE::ID);
+	 MixedInpSet::ObjectType* g = inp.CreateTransformObject(n, COMPLEX_DOUBLE::ID, tr, 1, p ? 3 : 0, IN_PLACE::ID);
+	 f->fft_many(&src[0], &dst[0], B, 2*dist);
+	 g->fft_many(&d[0], B, dist);
+	 delete f;
+	 delete g;
+	 for (int_t b=0; b<B; ++b) {
+	   vector<LC> l(x.begin() + b*dist, x.begin() + b*dist + n);
+	   l = dft(l, tr ? -1 : 1);
+	   c.add(rel_error(l, &dst[2*b*dist]), n, EpsD);
+	   c.add(rel_error(l, reinterpret_cast<double*>(&d[b*dist])), n, EpsD);
+	   // the gap stays untouched
+	   for (int_t k=n; k<dist; ++k)
+	     c.require(d[b*dist + k] == C(x[b*dist + k].real(), x[b*dist + k].imag()));
+	 }
+       }
+}
+
+// strided transforms, batches of columns and of rows
+void check_guru()
+{
+   Accuracy c("guru");
+   MixedSet set;
+   static const int_t Lens[] = { 17, 60, 97, 1000 };
+   const int_t C = 3, R = 2;
+   for (int_t i=0; i<4; ++i)
+     for (int_t tr=0; tr<2; ++tr)
+       for (int_t p=0; p<2; ++p)
+	 for (int mode=0; mode<3; ++mode) {
+	   const int_t n = Lens[i];
+	   // 0 - the columns of n x C, 1 - R x C contiguous transforms, 2 - the columns in-place
+	   vector<IODim> loops;
+	   if (mode == 1) {
+	     loops.push_back(IODim(R, n*C, n*C));
+	     loops.push_back(IODim(C, n, n));
+	   }
+	   else
+	     loops.push_back(IODim(C, 1, 1));
+	   const int_t stride = (mode == 1) ? 1 : C;
+	   vector<LC> x = random_data(n*R*C);
+	   vector<double> src(2*n*R*C), dst(2*n*R*C);
+	   to_interleaved(x, &src[0]);
+	   AbstractFFT_guru<double>* g = set.CreateGuruObject(n, DOUBLE::ID, tr, stride, stride, loops, p ? 3 : 0);
+	   double* out = (mode == 2) ? &src[0] : &dst[0];
+	   g->fft(&src[0], out);
+	   delete g;
+	   const int_t nb = (mode == 1) ? R*C : C;
+	   for (int_t b=0; b<nb; ++b) {
+	     const int_t off = (mode == 1) ? b*n : b;
+	     vector<LC> l(n);
+	     for (int_t k=0; k<n; ++k) l[k] = x[off + k*stride];
+	     c.add(rel_error(dft(l, tr ? -1 : 1), out + 2*off, stride), n, EpsD);
+	   }
+	 }
+}
+
+// the separate real and imaginary arrays, with small and large generic radices,
+// out of place and in place
+void check_split()
+{
+   Accuracy c("split-complex");
+   static const int_t Lens[] = { 1, 16, 60, 97, 1024, 1031 };
+   for (int_t i=0; i<6; ++i)
+     for (int_t tr=0; tr<2; ++tr)
+       for (int_t p=0; p<2; ++p) {
+	 const int_t n = Lens[i];
+	 vector<LC> x = random_data(n);
+	 vector<double> re(n), im(n), ore(n), oim(n);
+	 for (int_t k=0; k<n; ++k) {
+	   re[k] = x[k].real();
+	   im[k] = x[k].imag();
+	 }
+	 AbstractFFT_split<double>* f = RuntimeSplit<SPLIT_DOUBLE>::Create(n, tr, p ? 3 : 0);
+	 f->fft(&re[0], &im[0], &ore[0], &oim[0]);
+	 const vector<LC> r = dft(x, tr ? -1 : 1);
+	 vector<double> d(2*n);
+	 for (int_t k=0; k<n; ++k) {
+	   d[2*k] = ore[k];
+	   d[2*k+1] = oim[k];
+	 }
+	 c.add(rel_error(r, &d[0]), n, EpsD);
+	 // in place with the real and imaginary parts swapped
+	 f->fft(&re[0], &im[0], &im[0], &re[0]);
+	 delete f;
+	 for (int_t k=0; k<n; ++k) {
+	   d[2*k] = im[k];
+	   d[2*k+1] = re[k];
+	 }
+	 c.add(rel_error(r, &d[0]), n, EpsD);
+       }
+}
+
+// row-column transforms of the compiled lengths and of a runtime one
+void check_multidim()
+{
+   Accuracy c("multi-dimensional");
+   MultiSet set;
+   static const int_t Lens[] = { 8, 16, 12 };
+   for (int_t i=0; i<3; ++i)
+     for (int_t dim=2; dim<=3; ++dim)
+       for (int_t tr=0; tr<2; ++tr)
+	 for (int_t p=0; p<2; ++p) {
+	   const int_t n = Lens[i];
+	   int_t size = 1;
+	   for (int_t d=0; d<dim; ++d) size *= n;
+	   vector<LC> x = random_data(size);
+	   vector<double> src(2*size), dst(2*size);
+	   to_interleaved(x, &src[0]);
+	   MultiSet::ObjectType* f = set.CreateTransformObject(n, DOUBLE::ID, tr, dim, p ? 3 : 0, OUT_OF_PLACE::ID);
+	   f->fft(&src[0], &dst[0]);
+	   delete f;
+	   c.add(rel_error(dft_nd(x, n, tr ? -1 : 1), &dst[0]), size, EpsD);
+	 }
+}
+
+// the four-step plan of the lengths below its threshold, serial and in parallel
+void check_four_step()
+{
+   Accuracy c("four-step");
+   static const int_t Lens[] = { 1024, 3000, 4096 };
+   for (int_t i=0; i<3; ++i)
+     for (int nt=1; nt<=4; nt+=3) {
+       const int_t n = Lens[i];
+       vector<LC> x = random_data(n);
+       vector<double> src(2*n), dst(2*n);
+       to_interleaved(x, &src[0]);
+       RuntimeTransform<DOUBLE,DFT,OUT_OF_PLACE,RuntimeFourStep> f(n, nt);
+       f.fft(&src[0], &dst[0]);
+       c.add(rel_error(dft(x, 1), &dst[0]), n, EpsD);
+       RuntimeTransform<DOUBLE,IDFT,IN_PLACE,RuntimeFourStep> b(n, nt);
+       b.fft(&src[0]);
+       c.add(rel_error(dft(x, -1), &src[0]), n, EpsD);
+     }
+}
+
+// real-valued transforms: the compiled RDFT of 2N values to N+1 bins and RuntimeReal
+void check_real()
+{
+   Accuracy c("real-valued");
+   RealSet set;
+   static const int_t Lens[] = { 8, 15, 64, 45, 47, 1000 };
+   for (int_t i=0; i<6; ++i)
+     for (int_t p=0; p<2; ++p) {
+       // the compiled ones transform 2N reals, RuntimeReal transforms n reals
+       const bool compiled = (i < 3);
+       const int_t n = compiled ? 2*Lens[i] : Lens[i];
+       vector<LC> x(n);
+       vector<double> src(n), bins(n+2), back(n);
+       for (int_t k=0; k<n; ++k) {
+	 src[k] = rand()/double(RAND_MAX) - 0.5;
+	 x[k] = src[k];
+       }
+       AbstractFFT_oop<double>* f = compiled
+         ? set.CreateTransformObject(Lens[i], DOUBLE::ID, RDFT::ID, 1, p ? 3 : 0, OUT_OF_PLACE::ID)
+         : RuntimeReal<DOUBLE>::Create(n, RDFT::ID, p ? 3 : 0);
+       AbstractFFT_oop<double>* b = compiled
+         ? set.CreateTransformObject(Lens[i], DOUBLE::ID, IRDFT::ID, 1, p ? 3 : 0, OUT_OF_PLACE::ID)
+         : RuntimeReal<DOUBLE>::Create(n, IRDFT::ID, p ? 3 : 0);
+       f->fft(&src[0], &bins[0]);
+       vector<LC> r = dft(x, 1);
+       r.resize(n/2 + 1);
+       c.add(rel_error(r, &bins[0]), n, EpsD);
+       b->fft(&bins[0], &back[0]);
+       LD err = 0;
+       for (int_t k=0; k<n; ++k) 
+	 err = max(err, fabsl(back[k] - x[k].real()));
+       c.add(static_cast<double>(err/0.5L), n, EpsD);
+       delete f;
+       delete b;
+     }
+
+   // the packed in-place RuntimeReal of even lengths: bin n/2 in the imaginary part of bin 0
+   static const int_t Even[] = { 30, 1000 };
+   for (int_t i=0; i<2; ++i)
+     for (int nt=1; nt<=4; nt+=3) {
+       const int_t n = Even[i];
+       vector<LC> x(n);
+       vector<double> d(n);
+       for (int_t k=0; k<n; ++k) {
+	 d[k] = rand()/double(RAND_MAX) - 0.5;
+	 x[k] = d[k];
+       }
+       RealTransform<DOUBLE,RDFT,IN_PLACE> f(n, nt);
+       RealTransform<DOUBLE,IRDFT,IN_PLACE> b(n, nt);
+       f.fft(&d[0]);
+       vector<LC> r = dft(x, 1);
+       const LC nyq = r[n/2];
+       r.resize(n/2);
+       r[0] = LC(r[0].real(), nyq.real());
+       c.add(rel_error(r, &d[0]), n, EpsD);
+       b.fft(&d[0]);
+       LD err = 0;
+       for (int_t k=0; k<n; ++k)
+	 err = max(err, fabsl(d[k] - x[k].real()));
+       c.add(static_cast<double>(err/0.5L), n, EpsD);
+     }
+}
+
+// r2r transform of the type id by definition (FFTW's REDFT and RODFT)
+LD r2r(const int_t id, const vector<double>& x, const int_t k)
+{
+   const int_t n = x.size();
+   const LD pi = M_PIl;
+   LD s = 0;
+   switch (id) {
+     case DCT1::ID:
+       s = x[0] + ((k%2) ? -1 : 1)*x[n-1];
+       for (int_t j=1; j<n-1; ++j) s += 2*x[j]*cosl(pi*j*k/(n-1));
+       break;
+     case DCT2::ID:
+       for (int_t j=0; j<n; ++j) s += 2*x[j]*cosl(pi*(j+.5L)*k/n);
+       break;
+     case DCT3::ID:
+       s = x[0];
+       for (int_t j=1; j<n; ++j) s += 2*x[j]*cosl(pi*j*(k+.5L)/n);
+       break;
+     case DCT4::ID:
+       for (int_t j=0; j<n; ++j) s += 2*x[j]*cosl(pi*(j+.5L)*(k+.5L)/n);
+       break;
+     case DST1::ID:
+       for (int_t j=0; j<n; ++j) s += 2*x[j]*sinl(pi*(j+1)*(k+1)/(n+1));
+       break;
+     case DST2::ID:
+       for (int_t j=0; j<n; ++j) s += 2*x[j]*sinl(pi*(j+.5L)*(k+1)/n);
+       break;
+     case DST3::ID:
+       s = ((k%2) ? -1 : 1)*x[n-1];
+       for (int_t j=0; j<n-1; ++j) s += 2*x[j]*sinl(pi*(j+1)*(k+.5L)/n);
+       break;
+     case DST4::ID:
+       for (int_t j=0; j<n; ++j) s += 2*x[j]*sinl(pi*(j+.5L)*(k+.5L)/n);
+       break;
+   }
+   return s;
+}
+
+void check_r2r()
+{
+   Accuracy c("DCT, DST");
+   static const int_t Lens[] = { 2, 5, 16, 45, 100, 127 };
+   static const int_t Ids[] = { DCT1::ID, DCT2::ID, DCT3::ID, DCT4::ID, 
+                                DST1::ID, DST2::ID, DST3::ID, DST4::ID };
+   for (int_t i=0; i<6; ++i)
+     for (int_t t=0; t<8; ++t)
+       for (int_t p=0; p<2; ++p) {
+	 const int_t n = Lens[i];
+	 vector<double> x(n), y(n);
+	 for (int_t k=0; k<n; ++k) x[k] = rand()/double(RAND_MAX) - 0.5;
+	 AbstractFFT_oop<double>* f = RuntimeR2R<DOUBLE>::Create(n, Ids[t], p);
+	 f->fft(&x[0], &y[0]);
+	 delete f;
+	 LD err = 0, norm = 0;
+	 for (int_t k=0; k<n; ++k) {
+	   const LD r = r2r(Ids[t], x, k);
+	   err = max(err, fabsl(y[k] - r));
+	   norm = max(norm, fabsl(r));
+	 }
+	 c.add(static_cast<double>(err/norm), n, EpsD);
+       }
+
+   // IDCT1 and IDCT2 restore the input of DCT1 and DCT2 including the scaling
+   static const int_t Pairs[2][2] = { { DCT1::ID, IDCT1::ID }, { DCT2::ID, IDCT2::ID } };
+   for (int_t i=0; i<6; ++i)
+     for (int_t t=0; t<2; ++t) {
+       const int_t n = Lens[i];
+       vector<double> x(n), y(n), z(n);
+       for (int_t k=0; k<n; ++k) x[k] = rand()/double(RAND_MAX) - 0.5;
+       AbstractFFT_oop<double>* f = RuntimeR2R<DOUBLE>::Create(n, Pairs[t][0]);
+       AbstractFFT_oop<double>* b = RuntimeR2R<DOUBLE>::Create(n, Pairs[t][1]);
+       f->fft(&x[0], &y[0]);
+       b->fft(&y[0], &z[0]);
+       delete f;
+       delete b;
+       LD err = 0;
+       for (int_t k=0; k<n; ++k)
+	 err = max(err, fabsl(z[k] - x[k]));
+       c.add(static_cast<double>(err/0.5L), n, EpsD);
+     }
+}
+
+// direct linear convolution or correlation
+vector<LC> convolve(const vector<LC>& x, const vector<LC>& h, const bool corr)
+{
+   const int_t n = x.size(), k = h.size();
+   vector<LC> y(n+k-1);
+   for (int_t t=0; t<n+k-1; ++t)
+     for (int_t j=0; j<k; ++j) {
+       const int_t i = corr ? t+j-k+1 : t-j;
+       if (i >= 0 && i < n) 
+	 y[t] += (corr ? conj(h[j]) : h[j])*x[i];
+     }
+   return y;
+}
+
+void check_convolution()
+{
+   Accuracy c("convolution");
+   typedef complex<double> C;
+   ConvSet set;
+   static const int_t KLens[] = { 1, 17, 300, 1500 };
+   for (int_t i=0; i<4; ++i)
+     for (int op=0; op<2; ++op)
+       for (int method=0; method<2; ++method) {
+	 const int_t k = KLens[i], n = 2000;
+	 vector<LC> h = random_data(k), x = random_data(n);
+	 vector<LC> r = convolve(x, h, op == CORRELATION);
+	 vector<C> hc(k), xc(n), y(r.size()), ys(r.size());
+	 to_interleaved(h, reinterpret_cast<double*>(&hc[0]));
+	 to_interleaved(x, reinterpret_cast<double*>(&xc[0]));
+	 Convolution<ConvSet,COMPLEX_DOUBLE> conv(set, &hc[0], k, ConvOperation(op), ConvMethod(method), 3);
+	 conv.linear(&xc[0], n, &y[0]);
+	 c.add(rel_error(r, reinterpret_cast<double*>(&y[0])), conv.length(), EpsD);
+	 // streaming in the chunks of varying size
+	 int_t pos = 0, chunk = 1;
+	 while (pos < n) {
+	   const int_t len = min(chunk, n - pos);
+	   conv.process(&xc[pos], len, &ys[pos]);
+	   pos += len;
+	   chunk = chunk*3 % 397 + 1;
+	 }
+	 conv.flush(&ys[pos]);
+	 c.add(rel_error(r, reinterpret_cast<double*>(&ys[0])), conv.length(), EpsD);
+       }
+}
+
+// frames of a stream in chunks of random size and the overlap-add back
+void check_stft()
+{
+   Accuracy c("STFT, ISTFT");
+   static const int_t Lens[] = { 64, 45, 256 };
+   for (int_t i=0; i<3; ++i)
+     for (int_t p=0; p<2; ++p) {
+       const int_t n = Lens[i], hop = n/4, len = 3000;
+       vector<double> w(n), x(len);
+       for (int_t k=0; k<n; ++k) w[k] = 0.5 - 0.5*cos(2*M_PI*k/n);
+       for (int_t k=0; k<len; ++k) x[k] = rand()/double(RAND_MAX) - 0.5;
+
+       STFT<DOUBLE> stft(n, hop, &w[0], p ? 3 : 0);
+       const int_t nb = stft.bins();
+       const int_t nf = stft.frames(len);
+       vector<double> frames(2*nf*nb);
+       int_t pos = 0, f = 0;
+       while (pos < len) {
+	 const int_t chunk = min(len - pos, int_t(1 + rand()%300));
+	 f += stft.process(&x[pos], chunk, &frames[2*f*nb]);
+	 pos += chunk;
+       }
+       c.require(f == nf);
+       for (int_t m=0; m<nf; ++m) {
+	 vector<LC> l(n);
+	 for (int_t k=0; k<n; ++k) l[k] = LD(x[m*hop + k])*LD(w[k]);
+	 l = dft(l, 1);
+	 l.resize(nb);
+	 c.add(rel_error(l, &frames[2*m*nb]), n, EpsD);
+       }
+
+       ISTFT<DOUBLE> istft(n, hop, &w[0], p ? 3 : 0, 3);
+       vector<double> y(nf*hop + n - hop);
+       istft.process(&frames[0], nf, &y[0]);
+       istft.flush(&y[nf*hop]);
+       // the sum of the squared windows is small at both ends of the stream,
+       // so the reconstruction is checked, where n/hop frames overlap
+       LD err = 0;
+       for (int_t k=n-hop; k<nf*hop; ++k)
+	 err = max(err, fabsl(y[k] - LD(x[k])));
+       c.add(static_cast<double>(err/0.5L), n, EpsD);
+     }
+}
+
+// every instruction set level up to the one of this processor,
+// the vectorized scaled stages of OpenMP run for 1024
+void check_isa()
+{
+   Accuracy c("instruction set dispatch");
+   static const int_t Lens[] = { 64, 243, 1024, 100 };
+   for (int isa=0; isa<=cpu_isa(); ++isa) {
+     GenerateTransformISA<ISAList, DOUBLE, DFT, SIntID<1>, ParallList, OUT_OF_PLACE> set(isa);
+     GenerateTransformISA<ISAList, FLOAT, DFT, SIntID<1>, ParallList, OUT_OF_PLACE> fset(isa);
+     for (int_t i=0; i<4; ++i)
+       for (int_t p=0; p<2; ++p) {
+	 c.add(run_oop<DOUBLE>(set.CreateTransformObject(Lens[i], DOUBLE::ID, DFT::ID, 1, p ? 3 : 0, OUT_OF_PLACE::ID), Lens[i], DFT::ID), Lens[i], EpsD);
+	 c.add(run_oop<FLOAT>(fset.CreateTransformObject(Lens[i], FLOAT::ID, DFT::ID, 1, p ? 3 : 0, OUT_OF_PLACE::ID), Lens[i], DFT::ID), Lens[i], numeric_limits<float>::epsilon());
+       }
+   }
+}
+
+// the catalogue of libgfft and its runtime fallback for the lengths outside of it
+void check_library()
+{
+   Accuracy c("libgfft");
+   LibTransformSet<DOUBLE,OUT_OF_PLACE>::Result set;
+   LibTransformSet<COMPLEX_DOUBLE,IN_PLACE>::Result inp;
+   const int_t parall_id = GFFT_LIB_NUMTHREADS - 1;
+   const int_t Lens[] = { 1 << GFFT_LIB_PMIN, 1 << GFFT_LIB_PMAX, 2 << GFFT_LIB_PMAX, 1000 };
+   for (int_t i=0; i<4; ++i)
+     for (int_t tr=0; tr<2; ++tr) {
+       c.add(run_oop<DOUBLE>(set.CreateTransformObject(Lens[i], DOUBLE::ID, tr, 1, parall_id, OUT_OF_PLACE::ID), Lens[i], tr), Lens[i], EpsD);
+       c.add(run_inp<COMPLEX_DOUBLE>(inp.CreateTransformObject(Lens[i], COMPLEX_DOUBLE::ID, tr, 1, parall_id, IN_PLACE::ID), Lens[i], tr), Lens[i], EpsD);
+     }
+}
+
+int main(int argc, char *argv[])
+{
+   srand(1);
+   cout << "Maximal relative error, the bound is " << Tol << "*eps*(log2(n)+1):" << endl;
+   check_compiled();
+   check_variants();
+   check_planner();
+   check_plan_cache();
+   check_runtime();
+   check_library();
+   check_fft_many();
+   check_guru();
+   check_split();
+   check_multidim();
+   check_four_step();
+   check_real();
+   check_r2r();
+   check_convolution();
+   check_stft();
+   check_isa();
+   cout << "Feature check: " << (Failures ? "FAILED" : "passed") << endl;
+   return Failures ? 1 : 0;
+}
@@ -0,0 +1,166 @@
+/***************************************************************************
+ *   Copyright (C) 2015 by Vladimir Mirnyy                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ***************************************************************************/
+
+/** \file
+    \brief Correctness and memory bandwidth of the matrix transpose compared to memcpy
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstring>
+
+#include "gfft.h"
+
+using namespace std;
+
+using namespace GFFT;
+
+typedef DOUBLE VType;
+typedef VType::ValueType T;
+
+static const int_t MinP = 6;
+static const int_t MaxP = 12;
+
+// GB/s of reading and writing a matrix of n complex numbers in time t
+double bandwidth(const int_t n, const double t)
+{
+  return 2.*n*2*sizeof(T)/t*1e-9;
+}
+
+template<class Func>
+double measure(Func f)
+{
+  f();
+  double best = 0;
+  for (int round=0; round<5; ++round) {
+    int_t reps = 0;
+    const double t0 = plan_wtime();
+    double t;
+    do {
+      f();
+      ++reps;
+      t = plan_wtime() - t0;
+    } while (t < 0.1);
+    t /= reps;
+    if (round == 0 || t < best) best = t;
+  }
+  return best;
+}
+
+template<class Parall>
+struct Bench
+{
+  const T* src;
+  T* dst;
+  int_t rows, cols;
+  int mode;
+
+  void operator()() const
+  {
+    switch (mode) {
+      case 0: memcpy(dst, src, 2*rows*cols*sizeof(T)); break;
+      case 1: Transpose<VType,Parall>::apply(src, dst, rows, cols); break;
+      case 2: Transpose<VType,Parall>::apply(dst, rows, cols); break;
+    }
+  }
+};
+
+template<class Parall>
+void run(const int_t rows, const int_t cols)
+{
+  const int_t n = rows*cols;
+  vector<T> src(2*n), dst(2*n);
+  for (int_t i=0; i<2*n; ++i)
+    src[i] = T(i % 17);
+
+  Bench<Parall> b = { &src[0], &dst[0], rows, cols, 0 };
+  const double tc = measure(b);
+  b.mode = 1;
+  const double to = measure(b);
+  b.mode = 2;
+  const double ti = measure(b);
+
+  cout << setw(3) << Parall::NParProc << setw(7) << rows << " x" << setw(6) << cols
+       << setw(12) << bandwidth(n, tc)
+       << setw(14) << bandwidth(n, to) << setw(7) << 100.*tc/to << "%"
+       << setw(14) << bandwidth(n, ti) << setw(7) << 100.*tc/ti << "%" << endl;
+}
+
+// compares the transposes out-of-place and in-place with the naive one,
+// returns the number of mismatches
+template<class Parall>
+int_t check(const int_t rows, const int_t cols)
+{
+  const int_t n = rows*cols;
+  vector<T> src(2*n), ref(2*n), dst(2*n);
+  for (int_t i=0; i<2*n; ++i)
+    src[i] = T(i);
+  for (int_t i=0; i<rows; ++i)
+    for (int_t j=0; j<cols; ++j) {
+      ref[2*(j*rows + i)]   = src[2*(i*cols + j)];
+      ref[2*(j*rows + i)+1] = src[2*(i*cols + j)+1];
+    }
+
+  int_t err = 0;
+  Transpose<VType,Parall>::apply(&src[0], &dst[0], rows, cols);
+  for (int_t i=0; i<2*n; ++i)
+    if (dst[i] != ref[i]) ++err;
+
+  dst = src;
+  Transpose<VType,Parall>::apply(&dst[0], rows, cols);
+  for (int_t i=0; i<2*n; ++i)
+    if (dst[i] != ref[i]) ++err;
+
+  if (err)
+    cout << "FAILED " << Parall::NParProc << " threads " << rows << " x " << cols 
+         << ": " << err << " wrong values" << endl;
+  return err;
+}
+
+template<class Parall>
+int_t check_all()
+{
+  static const int_t Sizes[][2] = { {1,1}, {1,7}, {7,1}, {2,2}, {5,5}, {64,64}, {100,100}, 
+     {2,3}, {3,2}, {4,6}, {6,4}, {12,18}, {17,31}, {64,48}, {48,64}, {16,1024}, {1024,16}, 
+     {100,130}, {128,96}, {1000,3}, {3,1000}, {5000,2}, {2,5000}, {257,255} };
+  int_t err = 0;
+  for (size_t i=0; i<sizeof(Sizes)/sizeof(Sizes[0]); ++i)
+    err += check<Parall>(Sizes[i][0], Sizes[i][1]);
+  return err;
+}
+
+int main(int argc, char *argv[])
+{
+  const int_t err = check_all<Serial>() + check_all<OpenMP<4> >();
+  cout << "Transpose check: " << (err ? "FAILED" : "passed") << endl;
+  if (err) 
+    return 1;
+
+  cout.setf(ios::fixed);
+  cout.precision(2);
+  cout<<"------------------------------------------------------------------------"<<endl;
+  cout<<" NT       Size         memcpy   out-of-place           in-place         "<<endl;
+  cout<<"                       [GB/s]   [GB/s]   of memcpy     [GB/s] of memcpy "<<endl;
+  cout<<"------------------------------------------------------------------------"<<endl;
+
+  for (int_t p=MinP; p<=MaxP; p+=2) {
+    run<Serial>(1<<p, 1<<p);
+    run<OpenMP<4> >(1<<p, 1<<p);
+  }
+  run<Serial>(1<<MaxP, 1<<(MaxP-3));
+  run<OpenMP<4> >(1<<MaxP, 1<<(MaxP-3));
+
+  return 0;
+}